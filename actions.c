@@ -0,0 +1,180 @@
+/*
+ * actions.c: Actions on duplicate recordings, shared by the menu and SVDRP.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "actions.h"
+#include "config.h"
+#include "recording.h"
+#include "visibility.h"
+#include <vdr/menu.h>
+#include <vdr/videodir.h>
+
+#define STOPTIMEOUT 10 // seconds to wait for the recording being deleted
+
+bool SetHidden(const char *FileName, bool Hidden) {
+  return SetHidden(std::vector<std::string>(1, FileName), Hidden) == 1;
+}
+
+int SetHidden(const std::vector<std::string> &FileNames, bool Hidden) {
+  std::vector<std::string> changed;
+  for (std::vector<std::string>::const_iterator fileName = FileNames.begin(); fileName != FileNames.end(); ++fileName) {
+    if (cVisibility(fileName->c_str()).Write(!Hidden))
+      changed.push_back(*fileName);
+  }
+  if (changed.empty())
+    return 0;
+  DuplicateRecordingScanner.Trigger();
+  if (!dc.hidden)
+    DuplicateRecordings.Remove(changed);
+  return changed.size();
+}
+
+static bool DeleteRecording(const char *FileName) {
+  // Whether the recording is in use is checked right before, since it may
+  // have been replayed or edited since it was queued. The video directory is
+  // then renamed by VDR's own cRecording::Delete(), on a copy of the
+  // recording, so that no lock on the recordings is held while a slow or
+  // network disk is busy.
+  cStateKey recordingsStateKey;
+  const cRecordings *Recordings = cRecordings::GetRecordingsRead(recordingsStateKey);
+  const cRecording *recording = Recordings->GetByName(FileName);
+  bool exists = recording != NULL;
+  int inUse = recording ? recording->IsInUse() : ruNone;
+  recordingsStateKey.Remove();
+  if (inUse != ruNone) {
+    esyslog("duplicates: Recording %s is in use and wasn't deleted.", FileName);
+    return false;
+  }
+  if (exists && !cRecording(FileName).Delete()) {
+    esyslog("duplicates: Error while deleting recording %s.", FileName);
+    return false;
+  }
+  return true;
+}
+
+static void RemoveRecordings(const std::vector<std::string> &FileNames) {
+  // takes the deleted recordings out of VDR's list with one write lock, one
+  // state change and one disk usage check, the last replayed recording is
+  // cleared by the caller
+  cStateKey recordingsStateKey;
+  cRecordings *Recordings = cRecordings::GetRecordingsWrite(recordingsStateKey);
+  Recordings->SetExplicitModify();
+  for (std::vector<std::string>::const_iterator fileName = FileNames.begin(); fileName != FileNames.end(); ++fileName)
+    Recordings->DelByName(fileName->c_str());
+  Recordings->SetModified();
+  recordingsStateKey.Remove();
+  cVideoDiskUsage::ForceCheck();
+}
+
+// --- cDuplicateDeleterThread ----------------------------------------------
+
+cDuplicateDeleterThread::cDuplicateDeleterThread() : cThread("duplicate recording deleter", true) {
+  done = 0;
+  total = 0;
+}
+
+cDuplicateDeleterThread::~cDuplicateDeleterThread() {
+  Stop();
+}
+
+void cDuplicateDeleterThread::Stop(void) {
+  // The thread isn't canceled, since it might hold the lock on the
+  // recordings, but it stops after the recording being deleted. A rename
+  // that hangs, e.g. on a dead network disk, mustn't block the shutdown.
+  std::vector<std::string> dropped;
+  mutex.Lock();
+  dropped.assign(queue.begin(), queue.end());
+  queue.clear();
+  for (std::vector<std::string>::const_iterator fileName = dropped.begin(); fileName != dropped.end(); ++fileName)
+    pending.erase(*fileName);
+  Cancel(-1);
+  condition.Broadcast();
+  mutex.Unlock();
+  for (cTimeMs timeout(STOPTIMEOUT * 1000); Active(); cCondWait::SleepMs(10)) {
+    if (timeout.TimedOut()) {
+      esyslog("duplicates: Deleter thread didn't stop within %d seconds.", STOPTIMEOUT);
+      break;
+    }
+  }
+  if (!dropped.empty()) {
+    dsyslog("duplicates: Dropped %d recordings queued for deletion.", (int)dropped.size());
+    DuplicateRecordingScanner.Exclude(dropped, false);
+  }
+}
+
+int cDuplicateDeleterThread::Delete(const std::vector<std::string> &FileNames) {
+  std::vector<std::string> queued;
+  {
+    cMutexLock MutexLock(&mutex);
+    for (std::vector<std::string>::const_iterator fileName = FileNames.begin(); fileName != FileNames.end(); ++fileName) {
+      if (pending.insert(*fileName).second) {
+        queue.push_back(*fileName);
+        queued.push_back(*fileName);
+      }
+    }
+    total += queued.size();
+    condition.Broadcast();
+  }
+  for (std::vector<std::string>::const_iterator fileName = queued.begin(); fileName != queued.end(); ++fileName)
+    cReplayControl::ClearLastReplayed(fileName->c_str());
+  if (!queued.empty()) {
+    // stays out of the list until it's deleted
+    DuplicateRecordingScanner.Exclude(queued);
+    DuplicateRecordings.Remove(queued);
+  }
+  return queued.size();
+}
+
+bool cDuplicateDeleterThread::Progress(int &Done, int &Total) {
+  cMutexLock MutexLock(&mutex);
+  Done = done;
+  Total = total;
+  return total > 0;
+}
+
+void cDuplicateDeleterThread::Action(void) {
+  // Everything queued meanwhile is deleted as one batch, which is taken out
+  // of VDR's recordings with one write lock and one state change.
+  for (;;) {
+    std::vector<std::string> batch;
+    {
+      cMutexLock MutexLock(&mutex);
+      while (Running() && queue.empty())
+        condition.Wait(mutex);
+      if (queue.empty())
+        break;
+      batch.assign(queue.begin(), queue.end());
+      queue.clear();
+    }
+    std::vector<std::string> deleted;
+    int failed = 0;
+    for (size_t i = 0; i < batch.size() && Running(); i++) {
+      if (DeleteRecording(batch[i].c_str()))
+        deleted.push_back(batch[i]);
+      else
+        failed++;
+      cMutexLock MutexLock(&mutex);
+      done++;
+    }
+    if (!deleted.empty())
+      RemoveRecordings(deleted);
+    DuplicateRecordingScanner.Exclude(batch, false);
+    if (failed)
+      Skins.QueueMessage(mtError, trVDR("Error while deleting recording!"));
+    {
+      cMutexLock MutexLock(&mutex);
+      for (std::vector<std::string>::const_iterator fileName = batch.begin(); fileName != batch.end(); ++fileName)
+        pending.erase(*fileName);
+      if (queue.empty())
+        done = total = 0;
+    }
+    // recordings that couldn't be deleted are taken up again
+    DuplicateRecordingScanner.Trigger();
+  }
+}
+
+cDuplicateDeleterThread DuplicateDeleter;
@@ -0,0 +1,59 @@
+/*
+ * actions.h: Actions on duplicate recordings, shared by the menu and SVDRP.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_ACTIONS_H
+#define _DUPLICATES_ACTIONS_H
+
+#include <vdr/thread.h>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+bool SetHidden(const char *FileName, bool Hidden);
+  ///< Hides or unhides the recording FileName and updates the duplicate
+  ///< recordings list. Returns false if the hidden state couldn't be written.
+
+int SetHidden(const std::vector<std::string> &FileNames, bool Hidden);
+  ///< Hides or unhides all FileNames with one update of the duplicate
+  ///< recordings list. Returns the number of recordings changed.
+
+// --- cDuplicateDeleterThread ----------------------------------------------
+
+class cDuplicateDeleterThread : public cThread {
+private:
+  cMutex mutex;
+  cCondVar condition;
+  std::deque<std::string> queue;
+  std::set<std::string> pending; // queued or being deleted
+  int done;
+  int total;
+protected:
+  virtual void Action(void);
+public:
+  cDuplicateDeleterThread();
+  ~cDuplicateDeleterThread();
+  void Stop(void);
+      ///< Finishes the recording being deleted and stops the thread, but
+      ///< doesn't wait longer than ten seconds. The recordings still queued
+      ///< are dropped and come back with the next scan.
+  int Delete(const std::vector<std::string> &FileNames);
+      ///< Queues FileNames for deletion and removes them from the duplicate
+      ///< recordings list right away. A replay of one of them has to be
+      ///< stopped by the caller. Recordings that are in use or can't be
+      ///< deleted are reported and come back with the next scan.
+      ///< Returns the number of recordings queued, which leaves out those
+      ///< that are already queued.
+  bool Progress(int &Done, int &Total);
+      ///< Returns true while recordings are being deleted, with the number of
+      ///< recordings Done out of Total since the queue was last empty.
+};
+
+extern cDuplicateDeleterThread DuplicateDeleter;
+
+#endif
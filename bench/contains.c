@@ -0,0 +1,113 @@
+/*
+ * contains.c: Microbenchmark for the substring search of the duplicates plugin.
+ *
+ * Compares Contains() with std::string::find() on synthetic EPG
+ * descriptions that share many sentences, like the descriptions of
+ * episodes of the same series.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "../contains.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+
+static const char *Sentences[] = {
+  "Kommissar Wagner ermittelt in einem neuen Fall.",
+  "Eine junge Frau wird tot in ihrer Wohnung aufgefunden.",
+  "Die Spur führt in das Milieu der Hamburger Reeperbahn.",
+  "Währenddessen hat Lena mit privaten Problemen zu kämpfen.",
+  "Der Hauptverdächtige hat ein wasserdichtes Alibi.",
+  "Doch dann taucht ein neuer Zeuge auf.",
+  "Detective Inspector Barnaby is called to the village of Midsomer Wellow.",
+  "A local historian is found dead at the foot of the church tower.",
+  "The investigation uncovers a decades-old family feud.",
+  "Meanwhile, Joyce prepares for the annual flower show.",
+  "Dokumentation über die letzten Wildnisgebiete Europas.",
+  "Im Mittelpunkt stehen Wölfe, Luchse und Braunbären.",
+  "Die Filmemacher begleiten die Tiere über ein ganzes Jahr.",
+  "Regie: Hans Müller|Darsteller: Anna Schmidt, Peter Weber, Julia Hoffmann",
+  "Produktion: Deutschland 2017|Altersfreigabe: ab 12 Jahren",
+  "Folge 12: Der letzte Zeuge.",
+  "Folge 13: Tödliche Gewissheit.",
+  "Ein spannender Krimi mit überraschender Wendung.",
+  "Sport: Live-Übertragung aus dem Olympiastadion.",
+  "Im Anschluss folgen die Interviews mit den Spielern.",
+};
+
+#define SENTENCES (int)(sizeof(Sentences) / sizeof(Sentences[0]))
+
+static std::string Normalize(const std::string &s) {
+  std::string n;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] != ' ' && s[i] != '|')
+      n += s[i];
+  }
+  return n;
+}
+
+static std::string Description(void) {
+  std::string d;
+  int count = 3 + rand() % 10;
+  for (int i = 0; i < count; i++) {
+    d += Sentences[rand() % SENTENCES];
+    d += " ";
+  }
+  return Normalize(d);
+}
+
+static double Now(void) {
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 2000;
+  int pairs = argc > 2 ? atoi(argv[2]) : 2000000;
+  srand(42);
+  std::vector<std::string> descriptions;
+  for (int i = 0; i < count; i++) {
+    descriptions.push_back(Description());
+    if (i > 0 && rand() % 10 == 0) {
+      // a re-broadcast with a shorter description
+      const std::string &d = descriptions[rand() % i];
+      size_t start = rand() % (d.size() / 2 + 1);
+      descriptions.back() = d.substr(start, d.size() / 2);
+    }
+  }
+  std::vector<std::pair<int, int> > tests;
+  for (int i = 0; i < pairs; i++) {
+    int a = rand() % count, b = rand() % count;
+    if (descriptions[a].size() < descriptions[b].size())
+      std::swap(a, b);
+    tests.push_back(std::make_pair(a, b));
+  }
+  double bytes = 0;
+  for (size_t i = 0; i < tests.size(); i++)
+    bytes += descriptions[tests[i].first].size();
+
+  int foundFind = 0, foundContains = 0;
+  double start = Now();
+  for (size_t i = 0; i < tests.size(); i++) {
+    if (descriptions[tests[i].first].find(descriptions[tests[i].second]) != std::string::npos)
+      foundFind++;
+  }
+  double find = Now() - start;
+  start = Now();
+  for (size_t i = 0; i < tests.size(); i++) {
+    if (Contains(descriptions[tests[i].first], descriptions[tests[i].second]))
+      foundContains++;
+  }
+  double contains = Now() - start;
+
+  printf("%d descriptions, %d comparisons, %.1f MB searched\n", count, pairs, bytes / 1e6);
+  printf("std::string::find: %8.3f s %8.1f MB/s %d found\n", find, bytes / 1e6 / find, foundFind);
+  printf("Contains (%s): %8.3f s %8.1f MB/s %d found\n", ContainsImplementation(), contains, bytes / 1e6 / contains, foundContains);
+  return foundFind == foundContains ? 0 : 1;
+}
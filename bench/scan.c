@@ -0,0 +1,193 @@
+/*
+ * scan.c: Benchmark for the duplicate recording scanner.
+ *
+ * Generates a synthetic archive of recordings, with series whose episodes
+ * share a title, re-broadcasts with the same, a shortened or an extended
+ * description and a few recordings without description. Runs the scanner
+ * thread on it against the stand-in for VDR in vdr.c and reports the time
+ * of a full and an incremental scan, the comparisons per second and the
+ * peak memory usage. The scanner's statistics split the time of each
+ * scan into its phases.
+ *
+ * Usage: scan [-v] [recordings [duplicates (%) [threads [similarity (%)]]]]
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "../config.h"
+#include "../recording.h"
+#include <vdr/plugin.h>
+#include <vdr/videodir.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static const char *Syllables[] = {
+  "ka", "ter", "mon", "li", "sa", "ber", "en", "do", "ri", "chen", "tal", "wa",
+  "ge", "fon", "ne", "us", "ma", "stein", "o", "ha", "vi", "ko", "run", "de",
+  "bu", "lo", "schaft", "an", "pe", "it", "ste", "ru", "mi", "gel", "ton", "ei",
+  };
+
+#define SYLLABLES   (int)(sizeof(Syllables) / sizeof(Syllables[0]))
+#define WORDS       5000
+#define SERIES      8 // recordings per series title on average
+#define NODESCRIPTION 3 // % of the recordings
+
+struct tBroadcast {
+  std::string title;
+  std::string shortText;
+  std::string description;
+  };
+
+static std::vector<std::string> words;
+
+static std::string Word(void) {
+  std::string w;
+  for (int s = 1 + rand() % 3; s > 0; s--)
+    w += Syllables[rand() % SYLLABLES];
+  return w;
+}
+
+static const std::string &FrequentWord(void) {
+  // a roughly Zipf-like distribution, a few words are very frequent
+  double r = double(rand()) / RAND_MAX;
+  return words[int(r * r * r * (WORDS - 1))];
+}
+
+static std::string Text(int Words) {
+  std::string t;
+  for (int i = 0; i < Words; i++) {
+    if (i)
+      t += i % 12 ? " " : ". ";
+    t += FrequentWord();
+  }
+  return t + ".";
+}
+
+static tBroadcast Broadcast(const std::vector<std::string> &Titles) {
+  tBroadcast b;
+  b.title = Titles[rand() % Titles.size()];
+  if (rand() % 100 >= NODESCRIPTION) {
+    b.shortText = Text(2 + rand() % 4);
+    b.description = Text(40 + rand() % 160);
+  }
+  return b;
+}
+
+static tBroadcast Rebroadcast(const tBroadcast &Original) {
+  // the description of a re-broadcast is often shortened or extended
+  tBroadcast b = Original;
+  switch (rand() % 4) {
+    case 0: b.description.resize(b.description.size() * (50 + rand() % 50) / 100);
+            break;
+    case 1: b.description += "|Darsteller: " + Text(6);
+            break;
+    default: ;
+    }
+  return b;
+}
+
+static cString FileName(const tBroadcast &Broadcast, int Serial) {
+  std::string title = Broadcast.title;
+  for (size_t i = 0; i < title.size(); i++) {
+    if (title[i] == ' ')
+      title[i] = '_';
+  }
+  return cString::sprintf("%s/%s/%04d-%02d-%02d.20.15.%d-0.rec", cVideoDirectory::Name(), title.c_str(), 2000 + Serial / 10000 % 20, 1 + Serial / 28 % 12, 1 + Serial % 28, 1 + Serial % 97);
+}
+
+static double Now(void) {
+  return cTimeMs::Now() / 1000.0;
+}
+
+static cDuplicateScanStatistics WaitForScan(int Scans) {
+  // the statistics are updated when a scan has been published and saved
+  for (;;) {
+    cDuplicateScanStatistics statistics = DuplicateRecordingScanner.Statistics();
+    if (statistics.scans > Scans)
+      return statistics;
+    cCondWait::SleepMs(1);
+  }
+}
+
+static void Phases(const cDuplicateScanStatistics &Statistics) {
+  printf("    snapshot %d ms, normalize %d ms, compare %d ms, publish %d ms\n", Statistics.last[spSnapshot], Statistics.last[spNormalize], Statistics.last[spCompare], Statistics.last[spPublish]);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+    SysLogLevel = 3;
+    argc--;
+    argv++;
+  }
+  int count = argc > 1 ? atoi(argv[1]) : 10000;
+  int duplicates = argc > 2 ? atoi(argv[2]) : 20;
+  dc.threads = argc > 3 ? atoi(argv[3]) : 1;
+  dc.similarity = argc > 4 ? atoi(argv[4]) : 0;
+  dc.delay = 0;
+  char directory[] = "/tmp/duplicates-bench-XXXXXX";
+  if (!mkdtemp(directory)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  cPlugin::SetDirectory(directory);
+  srand(42);
+  for (int i = 0; i < WORDS; i++)
+    words.push_back(Word());
+  std::vector<std::string> titles;
+  for (int i = 0; i < count / SERIES + 1; i++)
+    titles.push_back(Text(1 + rand() % 3));
+  std::vector<tBroadcast> broadcasts;
+  cStateKey stateKey;
+  cRecordings *recordings = cRecordings::GetRecordingsWrite(stateKey);
+  for (int i = 0; i < count; i++) {
+    if (i > 0 && rand() % 100 < duplicates)
+      broadcasts.push_back(Rebroadcast(broadcasts[rand() % broadcasts.size()]));
+    else
+      broadcasts.push_back(Broadcast(titles));
+    const tBroadcast &b = broadcasts.back();
+    recordings->Add(new cRecording(FileName(b, i), b.title.c_str(), b.shortText.c_str(), b.description.c_str()));
+  }
+  stateKey.Remove();
+
+  // full scan
+  double start = Now();
+  DuplicateRecordingScanner.Start();
+  cDuplicateScanStatistics fullStatistics = WaitForScan(0);
+  double full = Now() - start;
+  uint64_t fullComparisons = fullStatistics.comparisons;
+  int groups = DuplicateRecordings.Get()->Groups();
+
+  // incremental scan after adding and deleting 1% of the recordings
+  int changes = std::max(count / 100, 1);
+  recordings = cRecordings::GetRecordingsWrite(stateKey);
+  for (int i = 0; i < changes && recordings->Count() > 0; i++)
+    recordings->Del(recordings->Get(rand() % recordings->Count()));
+  for (int i = 0; i < changes; i++) {
+    const tBroadcast &b = rand() % 100 < duplicates ? Rebroadcast(broadcasts[rand() % broadcasts.size()]) : Broadcast(titles);
+    recordings->Add(new cRecording(FileName(b, count + i), b.title.c_str(), b.shortText.c_str(), b.description.c_str()));
+  }
+  stateKey.Remove();
+  start = Now();
+  DuplicateRecordingScanner.Trigger();
+  cDuplicateScanStatistics incrementalStatistics = WaitForScan(fullStatistics.scans);
+  double incremental = Now() - start;
+  uint64_t incrementalComparisons = incrementalStatistics.comparisons - fullComparisons;
+  DuplicateRecordingScanner.Stop();
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  printf("%d recordings, %d%% duplicates, %d threads, similarity %d%%: %d groups\n", count, duplicates, dc.threads, dc.similarity, groups);
+  printf("  full scan:        %8.3f s, %10llu comparisons, %12.0f comparisons/s\n", full, (unsigned long long)fullComparisons, full > 0 ? fullComparisons / full : 0);
+  Phases(fullStatistics);
+  printf("  incremental scan: %8.3f s, %10llu comparisons, %12.0f comparisons/s\n", incremental, (unsigned long long)incrementalComparisons, incremental > 0 ? incrementalComparisons / incremental : 0);
+  Phases(incrementalStatistics);
+  printf("  peak memory:      %8.1f MB\n", usage.ru_maxrss / 1024.0);
+  if (system(cString::sprintf("rm -rf %s", directory)) != 0)
+    fprintf(stderr, "Could not remove %s\n", directory);
+  return 0;
+}
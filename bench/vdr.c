@@ -0,0 +1,375 @@
+/*
+ * vdr.c: Minimal stand-in for the parts of VDR used by the benchmarks.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "vdr/plugin.h"
+#include "vdr/recording.h"
+#include "vdr/thread.h"
+#include "vdr/videodir.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#include <time.h>
+
+// --- Logging -------------------------------------------------------------------
+
+int SysLogLevel = 0;
+
+void syslog_with_tid(int priority, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  vfprintf(stderr, format, ap);
+  fputc('\n', stderr);
+  va_end(ap);
+}
+
+// --- cString -------------------------------------------------------------------
+
+cString::cString(const char *S, bool TakePointer) {
+  s = TakePointer ? (char *)S : S ? strdup(S) : NULL;
+}
+
+cString::cString(const cString &String) {
+  s = String.s ? strdup(String.s) : NULL;
+}
+
+cString::~cString() {
+  free(s);
+}
+
+cString &cString::operator=(const cString &String) {
+  if (this != &String) {
+    free(s);
+    s = String.s ? strdup(String.s) : NULL;
+  }
+  return *this;
+}
+
+cString &cString::operator=(const char *String) {
+  if (s != String) {
+    free(s);
+    s = String ? strdup(String) : NULL;
+  }
+  return *this;
+}
+
+cString cString::sprintf(const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  char *buffer;
+  if (vasprintf(&buffer, fmt, ap) < 0)
+    buffer = NULL;
+  va_end(ap);
+  return cString(buffer, true);
+}
+
+cString AddDirectory(const char *DirName, const char *FileName) {
+  return cString::sprintf("%s/%s", DirName && *DirName ? DirName : ".", FileName);
+}
+
+// --- cTimeMs -------------------------------------------------------------------
+
+cTimeMs::cTimeMs(int Ms) {
+  Set(Ms);
+}
+
+uint64_t cTimeMs::Now(void) {
+  struct timespec tp;
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (uint64_t(tp.tv_sec)) * 1000 + tp.tv_nsec / 1000000;
+}
+
+void cTimeMs::Set(int Ms) {
+  begin = Now() + Ms;
+}
+
+bool cTimeMs::TimedOut(void) const {
+  return Now() >= begin;
+}
+
+uint64_t cTimeMs::Elapsed(void) const {
+  return Now() - begin;
+}
+
+// --- cListObject ---------------------------------------------------------------
+
+cListObject::cListObject(void) {
+  prev = next = NULL;
+}
+
+cListObject::~cListObject() {
+}
+
+void cListObject::Append(cListObject *Object) {
+  next = Object;
+  Object->prev = this;
+}
+
+void cListObject::Insert(cListObject *Object) {
+  prev = Object;
+  Object->next = this;
+}
+
+void cListObject::Unlink(void) {
+  if (next)
+    next->prev = prev;
+  if (prev)
+    prev->next = next;
+  next = prev = NULL;
+}
+
+// --- cListBase -----------------------------------------------------------------
+
+cListBase::cListBase(const char *NeedsLocking) {
+  objects = lastObject = NULL;
+  count = 0;
+}
+
+cListBase::~cListBase() {
+  Clear();
+}
+
+void cListBase::Add(cListObject *Object, cListObject *After) {
+  if (After && After != lastObject) {
+    After->Next()->Insert(Object);
+    After->Append(Object);
+  } else {
+    if (lastObject)
+      lastObject->Append(Object);
+    else
+      objects = Object;
+    lastObject = Object;
+  }
+  count++;
+}
+
+void cListBase::Del(cListObject *Object, bool DeleteObject) {
+  if (Object == objects)
+    objects = Object->Next();
+  if (Object == lastObject)
+    lastObject = Object->Prev();
+  Object->Unlink();
+  if (DeleteObject)
+    delete Object;
+  count--;
+}
+
+void cListBase::Clear(void) {
+  while (objects) {
+    cListObject *object = objects->Next();
+    delete objects;
+    objects = object;
+  }
+  objects = lastObject = NULL;
+  count = 0;
+}
+
+const cListObject *cListBase::Get(int Index) const {
+  if (Index < 0)
+    return NULL;
+  cListObject *object = objects;
+  while (object && Index-- > 0)
+    object = object->Next();
+  return object;
+}
+
+// --- cMutex --------------------------------------------------------------------
+
+cMutex::cMutex(void) {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+cMutex::~cMutex() {
+  pthread_mutex_destroy(&mutex);
+}
+
+void cMutex::Lock(void) {
+  pthread_mutex_lock(&mutex);
+}
+
+void cMutex::Unlock(void) {
+  pthread_mutex_unlock(&mutex);
+}
+
+// --- cMutexLock ----------------------------------------------------------------
+
+cMutexLock::cMutexLock(cMutex *Mutex) {
+  mutex = Mutex;
+  if (mutex)
+    mutex->Lock();
+}
+
+cMutexLock::~cMutexLock() {
+  if (mutex)
+    mutex->Unlock();
+}
+
+// --- cCondVar ------------------------------------------------------------------
+
+cCondVar::cCondVar(void) {
+  pthread_cond_init(&cond, NULL);
+}
+
+cCondVar::~cCondVar() {
+  pthread_cond_destroy(&cond);
+}
+
+void cCondVar::Wait(cMutex &Mutex) {
+  pthread_cond_wait(&cond, &Mutex.mutex);
+}
+
+bool cCondVar::TimedWait(cMutex &Mutex, int TimeoutMs) {
+  struct timespec abstime;
+  clock_gettime(CLOCK_REALTIME, &abstime);
+  abstime.tv_sec += TimeoutMs / 1000;
+  abstime.tv_nsec += (TimeoutMs % 1000) * 1000000;
+  if (abstime.tv_nsec >= 1000000000) {
+    abstime.tv_sec++;
+    abstime.tv_nsec -= 1000000000;
+  }
+  return pthread_cond_timedwait(&cond, &Mutex.mutex, &abstime) != ETIMEDOUT;
+}
+
+void cCondVar::Broadcast(void) {
+  pthread_cond_broadcast(&cond);
+}
+
+// --- cCondWait -----------------------------------------------------------------
+
+void cCondWait::SleepMs(int TimeoutMs) {
+  struct timespec t = { TimeoutMs / 1000, (TimeoutMs % 1000) * 1000000 };
+  nanosleep(&t, NULL);
+}
+
+// --- cThread -------------------------------------------------------------------
+
+cThread::cThread(const char *Description, bool LowPriority) {
+  childTid = 0;
+  active = running = false;
+}
+
+cThread::~cThread() {
+  Cancel(0);
+}
+
+void *cThread::StartThread(cThread *Thread) {
+  Thread->Action();
+  Thread->active = false;
+  return NULL;
+}
+
+bool cThread::Start(void) {
+  if (active)
+    return true;
+  active = running = true;
+  if (pthread_create(&childTid, NULL, (void *(*) (void *))&StartThread, (void *)this) != 0) {
+    childTid = 0;
+    active = running = false;
+    return false;
+  }
+  return true;
+}
+
+bool cThread::Active(void) {
+  return active;
+}
+
+void cThread::Cancel(int WaitSeconds) {
+  // unlike VDR, waits until the thread has ended instead of killing it
+  running = false;
+  if (WaitSeconds >= 0 && childTid) {
+    pthread_join(childTid, NULL);
+    childTid = 0;
+  }
+}
+
+// --- cStateKey and cRecordings -------------------------------------------------
+
+static pthread_rwlock_t recordingsLock = PTHREAD_RWLOCK_INITIALIZER;
+static int recordingsState = 0;
+static cRecordings recordings;
+
+cStateKey::cStateKey(bool IgnoreFirst) {
+  state = IgnoreFirst ? 0 : -1;
+  write = locked = false;
+}
+
+cStateKey::~cStateKey() {
+}
+
+void cStateKey::Reset(void) {
+  state = -1;
+}
+
+void cStateKey::Remove(bool IncState) {
+  if (locked) {
+    if (write && IncState)
+      recordingsState++;
+    locked = write = false;
+    pthread_rwlock_unlock(&recordingsLock);
+  }
+}
+
+const cRecordings *cRecordings::GetRecordingsRead(cStateKey &StateKey, int TimeoutMs) {
+  pthread_rwlock_rdlock(&recordingsLock);
+  if (StateKey.state == recordingsState) {
+    pthread_rwlock_unlock(&recordingsLock);
+    return NULL;
+  }
+  StateKey.state = recordingsState;
+  StateKey.locked = true;
+  return &recordings;
+}
+
+cRecordings *cRecordings::GetRecordingsWrite(cStateKey &StateKey, int TimeoutMs) {
+  pthread_rwlock_wrlock(&recordingsLock);
+  StateKey.state = recordingsState;
+  StateKey.write = StateKey.locked = true;
+  return &recordings;
+}
+
+// --- cRecording ----------------------------------------------------------------
+
+cRecording::cRecording(const char *FileName, const char *Title, const char *ShortText, const char *Description) {
+  fileName = FileName;
+  text = Title;
+  info.title = Title;
+  info.shortText = ShortText ? ShortText : "";
+  info.description = Description ? Description : "";
+  info.fileName = fileName + "/info";
+}
+
+// --- cVideoDirectory -----------------------------------------------------------
+
+const char *cVideoDirectory::Name(void) {
+  return "/video";
+}
+
+// --- cPlugin -------------------------------------------------------------------
+
+static cString directory;
+
+const char *cPlugin::ConfigDirectory(const char *PluginName) {
+  return directory;
+}
+
+const char *cPlugin::CacheDirectory(const char *PluginName) {
+  return directory;
+}
+
+void cPlugin::SetDirectory(const char *Directory) {
+  directory = Directory;
+}
+
+cPlugin *cPluginManager::GetPlugin(const char *Name) {
+  static cPlugin plugin;
+  return &plugin;
+}
@@ -0,0 +1,15 @@
+/*
+ * i18n.h: Minimal stand-in for VDR's i18n.h, used by the benchmarks.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __I18N_H
+#define __I18N_H
+
+#define tr(s) (s)
+#define trNOOP(s) (s)
+
+#endif //__I18N_H
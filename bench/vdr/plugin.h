@@ -0,0 +1,29 @@
+/*
+ * plugin.h: Minimal stand-in for VDR's plugin.h, used by the benchmarks.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __PLUGIN_H
+#define __PLUGIN_H
+
+#include "i18n.h"
+#include "tools.h"
+
+class cPlugin {
+public:
+  static const char *ConfigDirectory(const char *PluginName = NULL);
+  static const char *CacheDirectory(const char *PluginName = NULL);
+  static void SetDirectory(const char *Directory);
+      ///< Sets the config and cache directory (not in VDR).
+  void SetupStore(const char *Name, int Value) {}
+  };
+
+class cPluginManager {
+public:
+  static cPlugin *GetPlugin(const char *Name);
+  };
+
+#endif //__PLUGIN_H
@@ -0,0 +1,66 @@
+/*
+ * recording.h: Minimal stand-in for VDR's recording.h, used by the benchmarks.
+ *
+ * The recordings are kept in memory, the benchmark fills them in directly.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __RECORDING_H
+#define __RECORDING_H
+
+#include "i18n.h"
+#include "thread.h"
+#include "tools.h"
+#include <string>
+
+enum eRecordingUsage {
+  ruNone     = 0x0000,
+  ruTimer    = 0x0001,
+  ruReplay   = 0x0002,
+  ruCut      = 0x0004,
+  ruMove     = 0x0008,
+  ruCopy     = 0x0010,
+  ruSrc      = 0x0100,
+  ruDst      = 0x0200,
+  ruPending  = 0x1000,
+  ruCanceled = 0x2000,
+  };
+
+class cRecordingInfo {
+  friend class cRecording;
+private:
+  std::string title;
+  std::string shortText;
+  std::string description;
+  std::string fileName;
+public:
+  const char *Title(void) const { return title.empty() ? NULL : title.c_str(); }
+  const char *ShortText(void) const { return shortText.empty() ? NULL : shortText.c_str(); }
+  const char *Description(void) const { return description.empty() ? NULL : description.c_str(); }
+  const char *FileName(void) const { return fileName.c_str(); }
+  };
+
+class cRecording : public cListObject {
+private:
+  std::string fileName;
+  std::string text;
+  cRecordingInfo info;
+public:
+  cRecording(const char *FileName, const char *Title, const char *ShortText, const char *Description);
+  const char *FileName(void) const { return fileName.c_str(); }
+  const char *Title(char Delimiter = ' ', bool NewIndicator = false, int Level = -1) const { return text.c_str(); }
+  const cRecordingInfo *Info(void) const { return &info; }
+  double FramesPerSecond(void) const { return 25; }
+  int IsInUse(void) const { return ruNone; }
+  };
+
+class cRecordings : public cList<cRecording> {
+public:
+  static const cRecordings *GetRecordingsRead(cStateKey &StateKey, int TimeoutMs = 0);
+  static cRecordings *GetRecordingsWrite(cStateKey &StateKey, int TimeoutMs = 0);
+  };
+
+#endif //__RECORDING_H
@@ -0,0 +1,15 @@
+/*
+ * remux.h: Minimal stand-in for VDR's remux.h, used by the benchmarks.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __REMUX_H
+#define __REMUX_H
+
+#define TS_SIZE      188
+#define TS_SYNC_BYTE 0x47
+
+#endif //__REMUX_H
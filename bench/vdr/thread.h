@@ -0,0 +1,85 @@
+/*
+ * thread.h: Minimal stand-in for VDR's thread.h, used by the benchmarks.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __THREAD_H
+#define __THREAD_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+class cMutex {
+  friend class cCondVar;
+private:
+  pthread_mutex_t mutex;
+public:
+  cMutex(void);
+  ~cMutex();
+  void Lock(void);
+  void Unlock(void);
+  };
+
+class cCondVar {
+private:
+  pthread_cond_t cond;
+public:
+  cCondVar(void);
+  ~cCondVar();
+  void Wait(cMutex &Mutex);
+  bool TimedWait(cMutex &Mutex, int TimeoutMs);
+  void Broadcast(void);
+  };
+
+class cCondWait {
+public:
+  static void SleepMs(int TimeoutMs);
+  };
+
+class cMutexLock {
+private:
+  cMutex *mutex;
+public:
+  cMutexLock(cMutex *Mutex = NULL);
+  ~cMutexLock();
+  };
+
+class cThread {
+private:
+  pthread_t childTid;
+  bool active;
+  bool running;
+  static void *StartThread(cThread *Thread);
+protected:
+  virtual void Action(void) = 0;
+public:
+  cThread(const char *Description = NULL, bool LowPriority = false);
+  virtual ~cThread();
+  bool Start(void);
+  bool Active(void);
+  bool Running(void) { return running; }
+  void Cancel(int WaitSeconds = 0);
+  };
+
+class cStateKey {
+  friend class cRecordings;
+private:
+  int state;
+  bool write;
+  bool locked;
+public:
+  cStateKey(bool IgnoreFirst = false);
+  ~cStateKey();
+  void Reset(void);
+  void Remove(bool IncState = true);
+  };
+
+class cIoThrottle {
+public:
+  static bool Engaged(void) { return false; }
+  };
+
+#endif //__THREAD_H
@@ -0,0 +1,108 @@
+/*
+ * tools.h: Minimal stand-in for VDR's tools.h, used by the benchmarks.
+ *
+ * Only declares what the scanner of the duplicates plugin uses.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __TOOLS_H
+#define __TOOLS_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+typedef unsigned char uchar;
+
+extern int SysLogLevel;
+
+#define esyslog(a...) void( (SysLogLevel > 0) ? syslog_with_tid(LOG_ERR, a) : void() )
+#define isyslog(a...) void( (SysLogLevel > 1) ? syslog_with_tid(LOG_INFO, a) : void() )
+#define dsyslog(a...) void( (SysLogLevel > 2) ? syslog_with_tid(LOG_DEBUG, a) : void() )
+
+#define LOG_ERROR_STR(s) esyslog("ERROR (%s,%d): %s: %m", __FILE__, __LINE__, s)
+
+void syslog_with_tid(int priority, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
+
+#define MEGABYTE(n) ((n) * 1024LL * 1024LL)
+
+class cString {
+private:
+  char *s;
+public:
+  cString(const char *S = NULL, bool TakePointer = false);
+  cString(const cString &String);
+  virtual ~cString();
+  operator const void * () const { return s; }
+  operator const char * () const { return s; }
+  const char *operator*() const { return s; }
+  cString &operator=(const cString &String);
+  cString &operator=(const char *String);
+  static cString sprintf(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
+  };
+
+cString AddDirectory(const char *DirName, const char *FileName);
+
+class cTimeMs {
+private:
+  uint64_t begin;
+public:
+  cTimeMs(int Ms = 0);
+  static uint64_t Now(void);
+  void Set(int Ms = 0);
+  bool TimedOut(void) const;
+  uint64_t Elapsed(void) const;
+  };
+
+class cListObject {
+private:
+  cListObject *prev, *next;
+public:
+  cListObject(void);
+  virtual ~cListObject();
+  virtual int Compare(const cListObject &ListObject) const { return 0; }
+  void Append(cListObject *Object);
+  void Insert(cListObject *Object);
+  void Unlink(void);
+  cListObject *Prev(void) const { return prev; }
+  cListObject *Next(void) const { return next; }
+  };
+
+class cListBase {
+protected:
+  cListObject *objects, *lastObject;
+  int count;
+  cListBase(const char *NeedsLocking = NULL);
+public:
+  virtual ~cListBase();
+  void Add(cListObject *Object, cListObject *After = NULL);
+  void Del(cListObject *Object, bool DeleteObject = true);
+  virtual void Clear(void);
+  const cListObject *Get(int Index) const;
+  cListObject *Get(int Index) { return const_cast<cListObject *>(static_cast<const cListBase *>(this)->Get(Index)); }
+  int Count(void) const { return count; }
+  };
+
+template<class T> class cList : public cListBase {
+public:
+  cList(const char *NeedsLocking = NULL): cListBase(NeedsLocking) {}
+  const T *Get(int Index) const { return (T *)cListBase::Get(Index); }
+  const T *First(void) const { return (T *)objects; }
+  const T *Last(void) const { return (T *)lastObject; }
+  const T *Prev(const T *Object) const { return (T *)Object->cListObject::Prev(); }
+  const T *Next(const T *Object) const { return (T *)Object->cListObject::Next(); }
+  T *Get(int Index) { return const_cast<T *>(static_cast<const cList<T> *>(this)->Get(Index)); }
+  T *First(void) { return const_cast<T *>(static_cast<const cList<T> *>(this)->First()); }
+  T *Last(void) { return const_cast<T *>(static_cast<const cList<T> *>(this)->Last()); }
+  T *Prev(const T *Object) { return const_cast<T *>(static_cast<const cList<T> *>(this)->Prev(Object)); }
+  T *Next(const T *Object) { return const_cast<T *>(static_cast<const cList<T> *>(this)->Next(Object)); }
+  };
+
+#endif //__TOOLS_H
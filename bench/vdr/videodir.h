@@ -0,0 +1,17 @@
+/*
+ * videodir.h: Minimal stand-in for VDR's videodir.h, used by the benchmarks.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef __VIDEODIR_H
+#define __VIDEODIR_H
+
+class cVideoDirectory {
+public:
+  static const char *Name(void);
+  };
+
+#endif //__VIDEODIR_H
@@ -0,0 +1,164 @@
+/*
+ * cache.c: Persistent cache for the duplicate recording scanner.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "cache.h"
+#include <vdr/plugin.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <algorithm>
+
+#define CACHEMAGIC   "VDRDUPC"
+#define CACHEVERSION 4
+#define CACHEENTRYMIN (15 * sizeof(uint32_t)) // three empty strings and twelve integers
+
+// --- cInfoKey ------------------------------------------------------------------
+
+bool cInfoKey::Read(const char *InfoFileName) {
+  struct stat st;
+  if (InfoFileName && stat(InfoFileName, &st) == 0) {
+    mtime = st.st_mtime;
+    size = st.st_size;
+    return true;
+  }
+  mtime = 0;
+  size = -1;
+  return false;
+}
+
+// --- cDuplicateCache -----------------------------------------------------------
+
+static bool WriteInt(FILE *f, uint32_t Value) {
+  return fwrite(&Value, sizeof(Value), 1, f) == 1;
+}
+
+static bool ReadInt(FILE *f, uint32_t &Value) {
+  return fread(&Value, sizeof(Value), 1, f) == 1;
+}
+
+static bool WriteInt64(FILE *f, int64_t Value) {
+  return WriteInt(f, uint64_t(Value) >> 32) && WriteInt(f, uint64_t(Value) & 0xFFFFFFFF);
+}
+
+static bool ReadInt64(FILE *f, int64_t &Value) {
+  uint32_t high, low;
+  if (!ReadInt(f, high) || !ReadInt(f, low))
+    return false;
+  Value = int64_t((uint64_t(high) << 32) | low);
+  return true;
+}
+
+static bool WriteString(FILE *f, const std::string &Value) {
+  return WriteInt(f, Value.size()) && (Value.empty() || fwrite(Value.data(), Value.size(), 1, f) == 1);
+}
+
+static bool ReadString(FILE *f, std::string &Value) {
+  uint32_t size;
+  if (!ReadInt(f, size) || size > 0x100000)
+    return false;
+  Value.resize(size);
+  return size == 0 || fread(&Value[0], size, 1, f) == 1;
+}
+
+static bool ValidMatches(const std::vector<cDuplicateCacheEntry> &Entries) {
+  // every match has to be listed once on both sides
+  std::vector<std::pair<int, int> > pairs;
+  for (size_t i = 0; i < Entries.size(); i++) {
+    for (std::vector<int>::const_iterator m = Entries[i].matches.begin(); m != Entries[i].matches.end(); ++m)
+      pairs.push_back(std::make_pair(int(i), *m));
+  }
+  std::sort(pairs.begin(), pairs.end());
+  if (std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end())
+    return false;
+  for (std::vector<std::pair<int, int> >::const_iterator p = pairs.begin(); p != pairs.end(); ++p) {
+    if (!std::binary_search(pairs.begin(), pairs.end(), std::make_pair(p->second, p->first)))
+      return false;
+  }
+  return true;
+}
+
+cDuplicateCache::cDuplicateCache(void) {
+  fileName = AddDirectory(cPlugin::CacheDirectory(PLUGIN_NAME_I18N), "duplicates.cache");
+}
+
+bool cDuplicateCache::Load(std::vector<cDuplicateCacheEntry> &Entries, int Flags) {
+  Entries.clear();
+  FILE *f = fopen(fileName, "r");
+  if (!f)
+    return false;
+  char magic[sizeof(CACHEMAGIC)];
+  uint32_t version, flags, count;
+  bool ok = fread(magic, sizeof(magic), 1, f) == 1 && memcmp(magic, CACHEMAGIC, sizeof(magic)) == 0
+            && ReadInt(f, version) && version == CACHEVERSION
+            && ReadInt(f, flags) && (int)flags == Flags
+            && ReadInt(f, count);
+  if (ok) {
+    // the count isn't trusted beyond what the file can hold
+    struct stat st;
+    ok = fstat(fileno(f), &st) == 0 && count <= (st.st_size - ftell(f)) / CACHEENTRYMIN;
+  }
+  if (ok) {
+    Entries.resize(count);
+    for (uint32_t i = 0; ok && i < count; i++) {
+      cDuplicateCacheEntry &entry = Entries[i];
+      int64_t mtime, size;
+      uint32_t pending, fingerprinted, fingerprint1, fingerprint2, measured, length, fileSize, matches;
+      ok = ReadString(f, entry.fileName) && ReadInt64(f, mtime) && ReadInt64(f, size)
+           && ReadString(f, entry.title) && ReadString(f, entry.description)
+           && ReadInt(f, pending) && ReadInt(f, fingerprinted) && ReadInt(f, fingerprint1) && ReadInt(f, fingerprint2)
+           && ReadInt(f, measured) && ReadInt(f, length) && ReadInt(f, fileSize) && ReadInt(f, matches) && matches < count;
+      entry.key.mtime = mtime;
+      entry.key.size = size;
+      entry.pending = pending;
+      entry.fingerprinted = fingerprinted;
+      entry.fingerprint = (uint64_t(fingerprint1) << 32) | fingerprint2;
+      entry.measured = measured;
+      entry.length = length;
+      entry.size = fileSize;
+      for (uint32_t m = 0; ok && m < matches; m++) {
+        uint32_t match;
+        ok = ReadInt(f, match) && match < count && match != i;
+        entry.matches.push_back(match);
+      }
+    }
+  }
+  fclose(f);
+  if (ok)
+    ok = ValidMatches(Entries);
+  if (!ok) {
+    esyslog("duplicates: Ignoring invalid cache file %s.", *fileName);
+    Entries.clear();
+  }
+  return ok;
+}
+
+bool cDuplicateCache::Save(const std::vector<cDuplicateCacheEntry> &Entries, int Flags) {
+  cString tempName = cString::sprintf("%s.tmp", *fileName);
+  FILE *f = fopen(tempName, "w");
+  if (!f) {
+    LOG_ERROR_STR(*tempName);
+    return false;
+  }
+  bool ok = fwrite(CACHEMAGIC, sizeof(CACHEMAGIC), 1, f) == 1 && WriteInt(f, CACHEVERSION) && WriteInt(f, Flags) && WriteInt(f, Entries.size());
+  for (std::vector<cDuplicateCacheEntry>::const_iterator entry = Entries.begin(); ok && entry != Entries.end(); ++entry) {
+    ok = WriteString(f, entry->fileName) && WriteInt64(f, entry->key.mtime) && WriteInt64(f, entry->key.size)
+         && WriteString(f, entry->title) && WriteString(f, entry->description)
+         && WriteInt(f, entry->pending) && WriteInt(f, entry->fingerprinted)
+         && WriteInt(f, entry->fingerprint >> 32) && WriteInt(f, entry->fingerprint & 0xFFFFFFFF)
+         && WriteInt(f, entry->measured) && WriteInt(f, entry->length) && WriteInt(f, entry->size)
+         && WriteInt(f, entry->matches.size());
+    for (std::vector<int>::const_iterator m = entry->matches.begin(); ok && m != entry->matches.end(); ++m)
+      ok = WriteInt(f, *m);
+  }
+  if (fclose(f) != 0)
+    ok = false;
+  if (ok && rename(tempName, fileName) == 0)
+    return true;
+  LOG_ERROR_STR(*fileName);
+  remove(tempName);
+  return false;
+}
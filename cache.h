@@ -0,0 +1,56 @@
+/*
+ * cache.h: Persistent cache for the duplicate recording scanner.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_CACHE_H
+#define _DUPLICATES_CACHE_H
+
+#include <vdr/tools.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+// --- cInfoKey ------------------------------------------------------------------
+
+// Identifies the state of a recording's info file.
+
+struct cInfoKey {
+  time_t mtime;
+  off_t size;
+  cInfoKey(void) : mtime(0), size(-1) {}
+  bool Read(const char *InfoFileName);
+  bool operator==(const cInfoKey &Key) const { return mtime == Key.mtime && size == Key.size; }
+};
+
+// --- cDuplicateCacheEntry ------------------------------------------------------
+
+struct cDuplicateCacheEntry {
+  std::string fileName;
+  cInfoKey key;
+  std::string title;
+  std::string description;
+  bool pending;
+  bool fingerprinted;
+  uint64_t fingerprint;
+  bool measured;
+  int length;
+  int size;
+  std::vector<int> matches; // indexes of the matching entries
+};
+
+// --- cDuplicateCache -----------------------------------------------------------
+
+class cDuplicateCache {
+private:
+  cString fileName;
+public:
+  cDuplicateCache(void);
+  bool Load(std::vector<cDuplicateCacheEntry> &Entries, int Flags);
+  bool Save(const std::vector<cDuplicateCacheEntry> &Entries, int Flags);
+};
+
+#endif
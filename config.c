@@ -10,17 +10,54 @@
 #include <strings.h>
 #include <vdr/plugin.h>
 #include "config.h"
+#include "normalize.h"
+#include "recording.h"
+#include <algorithm>
 
 cDuplicatesConfig::cDuplicatesConfig() {
   title = 1;
   hidden = 0;
+  threads = 1;
+  whitespace = 0;
+  punctuation = 0;
+  casefold = 0;
+  umlauts = 0;
+  delay = 1000;
+  journal = 0;
+  similarity = 0;
+  fingerprint = 0;
+  lengthtolerance = 0;
+  sizetolerance = 0;
+  keep = kpNewest;
 }
 
 cDuplicatesConfig::~cDuplicatesConfig() {}
 
+int cDuplicatesConfig::Normalization(void) const {
+  return (whitespace ? nmWhitespace : 0) | (punctuation ? nmPunctuation : 0) | (casefold ? nmCase : 0) | (umlauts ? nmUmlauts : 0);
+}
+
+static int Clamp(const char *Value, int Min, int Max) {
+  // setup.conf may have been edited by hand, and the scanner's cache flags
+  // rely on the limits of the setup menu
+  return std::min(std::max(atoi(Value), Min), Max);
+}
+
 bool cDuplicatesConfig::SetupParse(const char *Name, const char *Value) {
-  if      (!strcasecmp(Name, "title"))     title = atoi(Value);
+  if      (!strcasecmp(Name, "title"))     title = Clamp(Value, 0, 1);
   else if (!strcasecmp(Name, "hidden"))    hidden = atoi(Value);
+  else if (!strcasecmp(Name, "threads"))   threads = Clamp(Value, 1, MAXCOMPARETHREADS);
+  else if (!strcasecmp(Name, "whitespace")) whitespace = atoi(Value);
+  else if (!strcasecmp(Name, "punctuation")) punctuation = atoi(Value);
+  else if (!strcasecmp(Name, "casefold"))  casefold = atoi(Value);
+  else if (!strcasecmp(Name, "umlauts"))   umlauts = atoi(Value);
+  else if (!strcasecmp(Name, "delay"))     delay = Clamp(Value, 0, MAXSCANDELAY);
+  else if (!strcasecmp(Name, "journal"))   journal = atoi(Value);
+  else if (!strcasecmp(Name, "similarity")) similarity = Clamp(Value, 0, MAXSIMILARITY);
+  else if (!strcasecmp(Name, "fingerprint")) fingerprint = atoi(Value);
+  else if (!strcasecmp(Name, "lengthtolerance")) lengthtolerance = Clamp(Value, 0, MAXLENGTHTOLERANCE);
+  else if (!strcasecmp(Name, "sizetolerance")) sizetolerance = Clamp(Value, 0, MAXSIZETOLERANCE);
+  else if (!strcasecmp(Name, "keep"))      keep = Clamp(Value, 0, kpCount - 1);
   else
     return false;
   return true;
@@ -28,6 +65,18 @@ bool cDuplicatesConfig::SetupParse(const char *Name, const char *Value) {
 
 void cDuplicatesConfig::Store(void) {
   cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("title", title);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("threads", threads);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("whitespace", whitespace);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("punctuation", punctuation);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("casefold", casefold);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("umlauts", umlauts);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("delay", delay);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("journal", journal);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("similarity", similarity);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("fingerprint", fingerprint);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("lengthtolerance", lengthtolerance);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("sizetolerance", sizetolerance);
+  cPluginManager::GetPlugin(PLUGIN_NAME_I18N)->SetupStore("keep", keep);
 }
 
 cDuplicatesConfig dc;
@@ -9,14 +9,33 @@
 #ifndef _DUPLICATES_CONFIG_H
 #define _DUPLICATES_CONFIG_H
 
+enum eKeep {
+  kpNewest,  // keeps the newest recording of a group when selecting
+  kpLargest, // keeps the largest one
+  kpCount
+};
+
 class cDuplicatesConfig {
   public:
     // variables
     int title;
     int hidden;
+    int threads;
+    int whitespace;
+    int punctuation;
+    int casefold;
+    int umlauts;
+    int delay;
+    int journal;
+    int similarity;
+    int fingerprint;
+    int lengthtolerance;
+    int sizetolerance;
+    int keep;
     // member functions
     cDuplicatesConfig();
     ~cDuplicatesConfig();
+    int Normalization(void) const;
     bool SetupParse(const char *Name, const char *Value);
     void Store(void);
 };
@@ -0,0 +1,102 @@
+/*
+ * contains.c: Substring search for duplicate detection.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "contains.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CONTAINS_X86
+#endif
+
+static bool ContainsScalar(const char *s, size_t n, const char *needle, size_t k) {
+  const char *end = s + n - k + 1;
+  const char last = needle[k - 1];
+  for (const char *p = s; p < end; p++) {
+    p = (const char *)memchr(p, needle[0], end - p);
+    if (!p)
+      return false;
+    if (p[k - 1] == last && memcmp(p + 1, needle + 1, k - 2) == 0)
+      return true;
+  }
+  return false;
+}
+
+#ifdef CONTAINS_X86
+
+__attribute__((target("sse2")))
+static bool ContainsSse2(const char *s, size_t n, const char *needle, size_t k) {
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[k - 1]);
+  size_t i = 0;
+  for (; i + k + 15 <= n; i += 16) {
+    __m128i blockFirst = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i blockLast = _mm_loadu_si128((const __m128i *)(s + i + k - 1));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+    while (mask) {
+      if (memcmp(s + i + __builtin_ctz(mask) + 1, needle + 1, k - 2) == 0)
+        return true;
+      mask &= mask - 1;
+    }
+  }
+  return i + k <= n && ContainsScalar(s + i, n - i, needle, k);
+}
+
+__attribute__((target("avx2")))
+static bool ContainsAvx2(const char *s, size_t n, const char *needle, size_t k) {
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[k - 1]);
+  size_t i = 0;
+  for (; i + k + 31 <= n; i += 32) {
+    __m256i blockFirst = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i blockLast = _mm256_loadu_si256((const __m256i *)(s + i + k - 1));
+    unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast)));
+    while (mask) {
+      if (memcmp(s + i + __builtin_ctz(mask) + 1, needle + 1, k - 2) == 0)
+        return true;
+      mask &= mask - 1;
+    }
+  }
+  return i + k <= n && ContainsScalar(s + i, n - i, needle, k);
+}
+
+#endif
+
+typedef bool (*tContains)(const char *, size_t, const char *, size_t);
+
+static tContains SelectContains(const char **Name) {
+#ifdef CONTAINS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    *Name = "avx2";
+    return ContainsAvx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    *Name = "sse2";
+    return ContainsSse2;
+  }
+#endif
+  *Name = "scalar";
+  return ContainsScalar;
+}
+
+static const char *containsName = NULL;
+static tContains containsFunction = SelectContains(&containsName);
+
+bool Contains(const char *Haystack, size_t HaystackSize, const char *Needle, size_t NeedleSize) {
+  if (NeedleSize == 0)
+    return true;
+  if (NeedleSize > HaystackSize)
+    return false;
+  if (NeedleSize == 1)
+    return memchr(Haystack, Needle[0], HaystackSize) != NULL;
+  return containsFunction(Haystack, HaystackSize, Needle, NeedleSize);
+}
+
+const char *ContainsImplementation(void) {
+  return containsName;
+}
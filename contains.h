@@ -0,0 +1,28 @@
+/*
+ * contains.h: Substring search for duplicate detection.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_CONTAINS_H
+#define _DUPLICATES_CONTAINS_H
+
+#include <stddef.h>
+#include <string>
+
+// Returns true if Needle is included in Haystack. Candidate positions are
+// found by comparing the first and the last byte of Needle with 32 (AVX2) or
+// 16 (SSE2) positions of Haystack at once, and only verified with memcmp().
+// The implementation is selected at runtime based on the CPU features.
+
+bool Contains(const char *Haystack, size_t HaystackSize, const char *Needle, size_t NeedleSize);
+
+inline bool Contains(const std::string &Haystack, const std::string &Needle) {
+  return Contains(Haystack.data(), Haystack.size(), Needle.data(), Needle.size());
+}
+
+const char *ContainsImplementation(void);
+
+#endif
@@ -8,9 +8,11 @@
 
 
 #include <vdr/plugin.h>
+#include "actions.h"
 #include "config.h"
 #include "menu.h"
 #include "recording.h"
+#include "services.h"
 
 static const char *VERSION        = "1.0.1";
 static const char *DESCRIPTION    = trNOOP("Shows duplicate recordings");
@@ -19,6 +21,7 @@ static const char *MAINMENUENTRY  = trNOOP("Duplicate recordings");
 class cPluginDuplicates : public cPlugin {
 private:
   // Add any member variables or functions you may need here.
+  cStateKey recordingsStateKey;
 public:
   cPluginDuplicates(void);
   virtual ~cPluginDuplicates();
@@ -70,11 +73,13 @@ bool cPluginDuplicates::Initialize(void) {
 bool cPluginDuplicates::Start(void) {
   // Start any background activities the plugin shall perform.
   DuplicateRecordingScanner.Start();
+  DuplicateDeleter.Start();
   return true;
 }
 
 void cPluginDuplicates::Stop(void) {
   // Stop any background activities the plugin is performing.
+  DuplicateDeleter.Stop();
   DuplicateRecordingScanner.Stop();
 }
 
@@ -85,6 +90,12 @@ void cPluginDuplicates::Housekeeping(void) {
 void cPluginDuplicates::MainThreadHook(void) {
   // Perform actions in the context of the main program thread.
   // WARNING: Use with great care - see PLUGINS.html!
+  // doesn't wait for a writer, the change is seen on one of the next passes
+  if (cRecordings::GetRecordingsRead(recordingsStateKey, 10)) {
+    recordingsStateKey.Remove();
+    DuplicateRecordingScanner.Trigger();
+  } else if (VisibilityCache.Changed())
+    DuplicateRecordingScanner.Trigger();
 }
 
 cString cPluginDuplicates::Active(void) {
@@ -114,16 +125,145 @@ bool cPluginDuplicates::SetupParse(const char *Name, const char *Value) {
 
 bool cPluginDuplicates::Service(const char *Id, void *Data) {
   // Handle custom service requests from other plugins
+  if (strcmp(Id, "Duplicates-View-v1.0") == 0) {
+    if (Data) {
+      Duplicates_View_v1_0 *view = (Duplicates_View_v1_0 *)Data;
+      view->view = DuplicateRecordings.Get();
+    }
+    return true;
+  } else if (strcmp(Id, "Duplicates-Lookup-v1.0") == 0) {
+    if (Data) {
+      Duplicates_Lookup_v1_0 *lookup = (Duplicates_Lookup_v1_0 *)Data;
+      std::shared_ptr<const cDuplicateGeneration> DuplicateGeneration = DuplicateRecordings.Get();
+      int recording = lookup->fileName ? DuplicateGeneration->Find(lookup->fileName) : -1;
+      int group = recording >= 0 ? DuplicateGeneration->Group(recording) : -1;
+      lookup->generation = DuplicateGeneration->Generation();
+      if (group >= 0 && DuplicateGeneration->IsDuplicates(group)) {
+        lookup->group = group;
+        lookup->duplicates = DuplicateGeneration->GroupRecording(group)->Duplicates()->Count();
+      } else {
+        lookup->group = -1;
+        lookup->duplicates = 0;
+      }
+    }
+    return true;
+  }
   return false;
 }
 
 const char **cPluginDuplicates::SVDRPHelpPages(void) {
   // Return help text for SVDRP commands this plugin implements
-  return NULL;
+  static const char *HelpPages[] = {
+    "LIST\n"
+    "    List the duplicate recordings, one recording per line as\n"
+    "    '<group> <hidden> <file name>'. Recordings with the same group\n"
+    "    number are duplicates of each other, hidden is 1 for a hidden\n"
+    "    recording and 0 otherwise.",
+    "HIDE <file name>\n"
+    "    Hide the recording with the given file name.",
+    "UNHIDE <file name>\n"
+    "    Unhide the recording with the given file name.",
+    "DELETE <file name>\n"
+    "    Delete the recording with the given file name. Only recordings\n"
+    "    in the list of duplicate recordings can be deleted, and only if\n"
+    "    they are not in use. The recording is deleted in the background,\n"
+    "    like from the menu, so errors are only logged and shown on the OSD.",
+    "STAT\n"
+    "    Show statistics of the duplicate recording scanner, one value per\n"
+    "    line as '<name> <value>'. Times are in ms, memory in bytes. The\n"
+    "    phase times are those of the last and the average of all finished\n"
+    "    scans, the counters are totals since VDR was started.",
+    NULL
+    };
+  return HelpPages;
+}
+
+static bool IsDuplicate(const char *FileName) {
+  return DuplicateRecordings.Get()->Find(FileName) >= 0;
+}
+
+static int RecordingInUse(const char *FileName) {
+  // returns -1 if there is no such recording
+  cStateKey StateKey;
+  const cRecordings *Recordings = cRecordings::GetRecordingsRead(StateKey);
+  const cRecording *Recording = Recordings->GetByName(FileName);
+  int InUse = Recording ? Recording->IsInUse() : -1;
+  StateKey.Remove();
+  return InUse;
 }
 
 cString cPluginDuplicates::SVDRPCommand(const char *Command, const char *Option, int &ReplyCode) {
   // Process SVDRP commands this plugin implements
+  if (strcasecmp(Command, "LIST") == 0) {
+    // works on the published list, so it never waits for a scan
+    std::shared_ptr<const cDuplicateGeneration> DuplicateGeneration = DuplicateRecordings.Get();
+    std::string reply;
+    for (int recording = 0; recording < DuplicateGeneration->Recordings(); recording++) {
+      const cDuplicateRecording *Duplicate = DuplicateGeneration->Recording(recording);
+      cVisibility visibility = Duplicate->Visibility();
+      if (visibility.Get() == UNKNOWN)
+        visibility.Read();
+      if (!reply.empty())
+        reply += "\n";
+      reply += *cString::sprintf("%d %d %s", DuplicateGeneration->Group(recording) + 1, visibility.Get() == HIDDEN, Duplicate->FileName().c_str());
+    }
+    if (reply.empty()) {
+      ReplyCode = 550;
+      return "No duplicate recordings";
+    }
+    return reply.c_str();
+  } else if (strcasecmp(Command, "HIDE") == 0 || strcasecmp(Command, "UNHIDE") == 0) {
+    bool hide = strcasecmp(Command, "HIDE") == 0;
+    if (!*Option) {
+      ReplyCode = 501;
+      return "Missing file name";
+    }
+    if (RecordingInUse(Option) < 0) {
+      ReplyCode = 550;
+      return cString::sprintf("Recording \"%s\" not found", Option);
+    }
+    if (!SetHidden(Option, hide)) {
+      ReplyCode = 554;
+      return cString::sprintf("Error while setting visibility of \"%s\"", Option);
+    }
+    return cString::sprintf("Recording \"%s\" %s", Option, hide ? "hidden" : "unhidden");
+  } else if (strcasecmp(Command, "DELETE") == 0) {
+    if (!*Option) {
+      ReplyCode = 501;
+      return "Missing file name";
+    }
+    if (!IsDuplicate(Option)) {
+      ReplyCode = 550;
+      return cString::sprintf("Recording \"%s\" is not a duplicate recording", Option);
+    }
+    int InUse = RecordingInUse(Option);
+    if (InUse < 0) {
+      ReplyCode = 550;
+      return cString::sprintf("Recording \"%s\" not found", Option);
+    }
+    if (InUse) {
+      ReplyCode = 550;
+      return cString::sprintf("Recording \"%s\" is in use", Option);
+    }
+    // same path as the menu, so errors are reported on the OSD and in the log
+    if (!DuplicateDeleter.Delete(std::vector<std::string>(1, Option))) {
+      ReplyCode = 550;
+      return cString::sprintf("Recording \"%s\" is already being deleted", Option);
+    }
+    return cString::sprintf("Recording \"%s\" queued for deletion", Option);
+  } else if (strcasecmp(Command, "STAT") == 0) {
+    static const char *PhaseNames[spCount] = { "snapshot", "normalize", "compare", "publish" };
+    cDuplicateScanStatistics statistics = DuplicateRecordingScanner.Statistics();
+    cString reply = cString::sprintf("scans %d\naborted %d\n", statistics.scans, statistics.aborted);
+    for (int p = 0; p < spCount; p++)
+      reply = cString::sprintf("%slast_%s %d\n", *reply, PhaseNames[p], statistics.last[p]);
+    for (int p = 0; p < spCount; p++)
+      reply = cString::sprintf("%saverage_%s %d\n", *reply, PhaseNames[p], statistics.scans ? int(statistics.total[p] / statistics.scans) : 0);
+    return cString::sprintf("%scomparisons %llu\ncandidates %llu\nlock_wait %d\nlock_hold %d\nrecordings %d\ngroups %d\nresult_memory %zu\ntable_memory %zu",
+                            *reply, (unsigned long long)statistics.comparisons, (unsigned long long)statistics.candidates,
+                            statistics.lockWait, statistics.lockHold, statistics.recordings, statistics.groups,
+                            statistics.resultMemory, statistics.tableMemory);
+  }
   return NULL;
 }
 
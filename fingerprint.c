@@ -0,0 +1,86 @@
+/*
+ * fingerprint.c: Content fingerprints and measures of recordings.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "fingerprint.h"
+#include <vdr/recording.h>
+#include <vdr/remux.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <vector>
+
+#define MAXTSFILES     65535
+#define INDEXENTRYSIZE 8 // the size of a tIndexTs in VDR's index file
+
+static uint64_t Hash(uint64_t Hash, const void *Data, size_t Size) {
+  // FNV-1a
+  const unsigned char *p = (const unsigned char *)Data;
+  for (size_t i = 0; i < Size; i++) {
+    Hash ^= p[i];
+    Hash *= 0x100000001B3ULL;
+  }
+  return Hash;
+}
+
+static off_t TsFileSizes(const char *FileName, std::vector<off_t> &Sizes) {
+  off_t total = 0;
+  struct stat st;
+  for (int i = 1; i <= MAXTSFILES; i++) {
+    if (stat(cString::sprintf("%s/%05d.ts", FileName, i), &st) != 0)
+      break;
+    Sizes.push_back(st.st_size);
+    total += st.st_size;
+  }
+  return total;
+}
+
+static off_t IndexFileSize(const char *FileName) {
+  struct stat st;
+  return stat(AddDirectory(FileName, "index"), &st) == 0 ? st.st_size : 0;
+}
+
+bool Fingerprint(const char *FileName, uint64_t &Fingerprint) {
+  std::vector<off_t> sizes;
+  off_t total = TsFileSizes(FileName, sizes);
+  if (total < TS_SIZE * FINGERPRINTSAMPLES)
+    return false;
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  hash = Hash(hash, &total, sizeof(total));
+  off_t indexSize = IndexFileSize(FileName);
+  hash = Hash(hash, &indexSize, sizeof(indexSize));
+  int fd = -1;
+  size_t file = 0;
+  off_t fileStart = 0;
+  uchar packet[TS_SIZE];
+  for (int s = 0; s < FINGERPRINTSAMPLES; s++) {
+    off_t offset = total / (2 * FINGERPRINTSAMPLES) * (2 * s + 1) / TS_SIZE * TS_SIZE;
+    bool opened = fd >= 0;
+    while (offset >= fileStart + sizes[file]) {
+      fileStart += sizes[file++];
+      opened = false;
+    }
+    if (!opened) {
+      if (fd >= 0)
+        close(fd);
+      fd = open(cString::sprintf("%s/%05d.ts", FileName, int(file + 1)), O_RDONLY);
+      if (fd < 0)
+        return false;
+    }
+    if (pread(fd, packet, TS_SIZE, offset - fileStart) == TS_SIZE && packet[0] == TS_SYNC_BYTE)
+      hash = Hash(hash, packet + 4, TS_SIZE - 4);
+  }
+  if (fd >= 0)
+    close(fd);
+  Fingerprint = hash;
+  return true;
+}
+
+void Measure(const char *FileName, double FramesPerSecond, int &Length, int &Size) {
+  std::vector<off_t> sizes;
+  Size = TsFileSizes(FileName, sizes) / MEGABYTE(1);
+  Length = FramesPerSecond > 0 ? int(IndexFileSize(FileName) / INDEXENTRYSIZE / FramesPerSecond) : 0;
+}
@@ -0,0 +1,30 @@
+/*
+ * fingerprint.h: Content fingerprints and measures of recordings.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_FINGERPRINT_H
+#define _DUPLICATES_FINGERPRINT_H
+
+#include <stdint.h>
+
+#define FINGERPRINTSAMPLES  16
+#define FINGERPRINTINTERVAL 50 // ms, minimum time between two fingerprints
+
+bool Fingerprint(const char *FileName, uint64_t &Fingerprint);
+  ///< Computes a fingerprint of the recording in the directory FileName from
+  ///< the size of its index file, the size of its TS files and the payload of
+  ///< FINGERPRINTSAMPLES packets at fixed relative offsets. Only a few KB are
+  ///< read, so the fingerprint identifies copies of the same recording, not
+  ///< different recordings of the same broadcast. Returns false if the
+  ///< recording has no TS files.
+
+void Measure(const char *FileName, double FramesPerSecond, int &Length, int &Size);
+  ///< Determines the Length (in seconds) of the recording in the directory
+  ///< FileName from the size of its index file and the Size (in MB) of its
+  ///< TS files. Both are 0 if they are unknown, like for PES recordings.
+
+#endif
@@ -0,0 +1,232 @@
+/*
+ * index.c: Candidate index for duplicate detection.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "index.h"
+#include <math.h>
+#include <algorithm>
+
+// --- cContainmentIndex ---------------------------------------------------------
+
+void cContainmentIndex::Grams(const char *Description, size_t Size, std::vector<uint32_t> &Grams) {
+  Grams.clear();
+  if (Size < Q)
+    return;
+  const unsigned char *s = (const unsigned char *)Description;
+  uint32_t gram = (s[0] << 16) | (s[1] << 8) | s[2];
+  for (size_t i = Q - 1; i < Size; i++) {
+    gram = (gram << 8) | s[i];
+    Grams.push_back(gram);
+  }
+  std::sort(Grams.begin(), Grams.end());
+  Grams.erase(std::unique(Grams.begin(), Grams.end()), Grams.end());
+}
+
+cContainmentIndex::cContainmentIndex(void) {
+  live = 0;
+  garbage = 0;
+}
+
+void cContainmentIndex::Clear(void) {
+  postings.clear();
+  signatures.clear();
+  shortIds.clear();
+  deleted.clear();
+  live = 0;
+  garbage = 0;
+}
+
+void cContainmentIndex::Count(int Id, const char *Description, size_t Size) {
+  // Counting all descriptions before adding them gives better signatures.
+  std::vector<uint32_t> grams;
+  Grams(Description, Size, grams);
+  for (std::vector<uint32_t>::const_iterator g = grams.begin(); g != grams.end(); ++g)
+    postings[*g].push_back(Id);
+}
+
+void cContainmentIndex::Add(int Id, const char *Description, size_t Size) {
+  if (Id < (int)deleted.size())
+    deleted[Id] = false;
+  live++;
+  std::vector<uint32_t> grams;
+  Grams(Description, Size, grams);
+  if (grams.empty()) {
+    shortIds.push_back(Id);
+    return;
+  }
+  uint32_t signature = grams.front();
+  size_t rarest = 0;
+  for (std::vector<uint32_t>::const_iterator g = grams.begin(); g != grams.end(); ++g) {
+    std::unordered_map<uint32_t, std::vector<int> >::const_iterator p = postings.find(*g);
+    size_t count = p != postings.end() ? p->second.size() : 0;
+    if (g == grams.begin() || count < rarest) {
+      rarest = count;
+      signature = *g;
+    }
+  }
+  signatures[signature].push_back(Id);
+}
+
+void cContainmentIndex::Del(int Id) {
+  if (Id >= (int)deleted.size())
+    deleted.resize(Id + 1, false);
+  deleted[Id] = true;
+  live--;
+  garbage++;
+}
+
+void cContainmentIndex::Candidates(int Id, const char *Description, size_t Size, std::vector<int> &Ids) const {
+  // Appends the ids of all indexed descriptions that may be included in
+  // Description or that may include it. The result is sorted and unique.
+  std::vector<uint32_t> grams;
+  Grams(Description, Size, grams);
+  const std::vector<int> *including = NULL;
+  for (std::vector<uint32_t>::const_iterator g = grams.begin(); g != grams.end(); ++g) {
+    std::unordered_map<uint32_t, std::vector<int> >::const_iterator p = postings.find(*g);
+    if (p != postings.end() && (!including || p->second.size() < including->size()))
+      including = &p->second;
+    std::unordered_map<uint32_t, std::vector<int> >::const_iterator s = signatures.find(*g);
+    if (s != signatures.end())
+      Ids.insert(Ids.end(), s->second.begin(), s->second.end());
+  }
+  if (including)
+    Ids.insert(Ids.end(), including->begin(), including->end());
+  else if (grams.empty()) {
+    // a description shorter than a q-gram may be included in any other one
+    for (std::unordered_map<uint32_t, std::vector<int> >::const_iterator s = signatures.begin(); s != signatures.end(); ++s)
+      Ids.insert(Ids.end(), s->second.begin(), s->second.end());
+  }
+  Ids.insert(Ids.end(), shortIds.begin(), shortIds.end());
+  std::sort(Ids.begin(), Ids.end());
+  Ids.erase(std::unique(Ids.begin(), Ids.end()), Ids.end());
+  if (garbage) {
+    std::vector<int>::iterator kept = Ids.begin();
+    for (std::vector<int>::const_iterator i = Ids.begin(); i != Ids.end(); ++i) {
+      if (*i >= (int)deleted.size() || !deleted[*i])
+        *kept++ = *i;
+    }
+    Ids.erase(kept, Ids.end());
+  }
+  std::vector<int>::iterator self = std::lower_bound(Ids.begin(), Ids.end(), Id);
+  if (self != Ids.end() && *self == Id)
+    Ids.erase(self);
+}
+
+// --- cSimilarityIndex ----------------------------------------------------------
+
+static inline uint64_t Mix(uint64_t x) {
+  // splitmix64 finalizer
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+cSimilarityIndex::cSimilarityIndex(void) {
+  rows = 4;
+}
+
+void cSimilarityIndex::Erase(std::vector<int> &Ids, int Id) {
+  std::vector<int>::iterator i = std::find(Ids.begin(), Ids.end(), Id);
+  if (i != Ids.end()) {
+    *i = Ids.back();
+    Ids.pop_back();
+  }
+}
+
+void cSimilarityIndex::Clear(int Threshold) {
+  // With b bands of r rows, pairs with a similarity s become candidates with
+  // the probability 1 - (1 - s^r)^b, which rises steeply around (1/b)^(1/r).
+  // The largest r that keeps this point well below the threshold is used.
+  static const int Rows[] = { 8, 4, 2, 1 };
+  rows = 1;
+  for (size_t i = 0; i < sizeof(Rows) / sizeof(Rows[0]); i++) {
+    if (pow(double(Rows[i]) / K, 1.0 / Rows[i]) * 100 <= Threshold - 10) {
+      rows = Rows[i];
+      break;
+    }
+  }
+  signatures.clear();
+  indexed.clear();
+  buckets.clear();
+}
+
+uint64_t cSimilarityIndex::Bucket(int Id, int Band) const {
+  const uint32_t *values = &signatures[Id * K + Band * rows];
+  uint64_t bucket = Band;
+  for (int r = 0; r < rows; r++)
+    bucket = Mix(bucket ^ (uint64_t(values[r]) << 8));
+  return bucket;
+}
+
+void cSimilarityIndex::Add(int Id, const char *Description, size_t Size) {
+  if (Size < SHINGLE)
+    return; // too short to be similar in any meaningful way
+  if (Id >= (int)indexed.size()) {
+    indexed.resize(Id + 1, false);
+    signatures.resize((Id + 1) * K);
+  }
+  uint32_t *signature = &signatures[Id * K];
+  std::fill(signature, signature + K, UINT32_MAX);
+  const unsigned char *s = (const unsigned char *)Description;
+  uint64_t shingle = 0;
+  for (size_t i = 0; i < Size; i++) {
+    shingle = ((shingle << 8) | s[i]) & ((1ULL << (8 * SHINGLE)) - 1);
+    if (i + 1 < SHINGLE)
+      continue;
+    uint64_t h = Mix(shingle);
+    for (int k = 0; k < K; k++) {
+      // K hash functions derived from one by multiplication with odd constants
+      uint32_t v = (h * (0x9E3779B97F4A7C15ULL + 2 * k * 0xD6E8FEB86659FD93ULL)) >> 32;
+      if (v < signature[k])
+        signature[k] = v;
+    }
+  }
+  indexed[Id] = true;
+  for (int b = 0; b < K / rows; b++)
+    buckets[Bucket(Id, b)].push_back(Id);
+}
+
+void cSimilarityIndex::Del(int Id) {
+  if (Id >= (int)indexed.size() || !indexed[Id])
+    return;
+  for (int b = 0; b < K / rows; b++) {
+    std::unordered_map<uint64_t, std::vector<int> >::iterator bucket = buckets.find(Bucket(Id, b));
+    if (bucket != buckets.end()) {
+      Erase(bucket->second, Id);
+      if (bucket->second.empty())
+        buckets.erase(bucket);
+    }
+  }
+  indexed[Id] = false;
+}
+
+void cSimilarityIndex::Candidates(int Id, std::vector<int> &Ids) const {
+  if (Id >= (int)indexed.size() || !indexed[Id])
+    return;
+  for (int b = 0; b < K / rows; b++) {
+    std::unordered_map<uint64_t, std::vector<int> >::const_iterator bucket = buckets.find(Bucket(Id, b));
+    if (bucket != buckets.end()) {
+      for (std::vector<int>::const_iterator i = bucket->second.begin(); i != bucket->second.end(); ++i) {
+        if (*i != Id)
+          Ids.push_back(*i);
+      }
+    }
+  }
+}
+
+int cSimilarityIndex::Similarity(int Id1, int Id2) const {
+  if (Id1 >= (int)indexed.size() || Id2 >= (int)indexed.size() || !indexed[Id1] || !indexed[Id2])
+    return 0;
+  const uint32_t *s1 = &signatures[Id1 * K];
+  const uint32_t *s2 = &signatures[Id2 * K];
+  int equal = 0;
+  for (int k = 0; k < K; k++)
+    equal += s1[k] == s2[k];
+  return equal * 100 / K;
+}
@@ -0,0 +1,82 @@
+/*
+ * index.h: Candidate index for duplicate detection.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_INDEX_H
+#define _DUPLICATES_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+// --- cContainmentIndex ---------------------------------------------------------
+
+// Finds candidates for "shorter description is included in the longer one"
+// without comparing all pairs. Every description is indexed by its rarest
+// q-gram (its signature). A description can only be included in another one
+// if the other one contains all of its q-grams, and so also its signature.
+// Candidates are verified with the exact comparison by the caller.
+// Deleted descriptions are only marked, since their posting lists may hold
+// most of the archive. Their entries stay behind as candidates that are
+// filtered out, or that the exact comparison rejects if the id has been
+// reused, until the caller rebuilds the index.
+
+class cContainmentIndex {
+private:
+  std::unordered_map<uint32_t, std::vector<int> > postings;
+  std::unordered_map<uint32_t, std::vector<int> > signatures;
+  std::vector<int> shortIds;
+  std::vector<bool> deleted;
+  int live;
+  int garbage;
+  static void Grams(const char *Description, size_t Size, std::vector<uint32_t> &Grams);
+public:
+  enum { Q = 4 };
+  cContainmentIndex(void);
+  void Clear(void);
+  void Count(int Id, const char *Description, size_t Size);
+  void Add(int Id, const char *Description, size_t Size);
+  void Del(int Id);
+  void Candidates(int Id, const char *Description, size_t Size, std::vector<int> &Ids) const;
+  bool NeedsRebuild(void) const { return garbage > live / 4 + 256; }
+      ///< Returns true if so many descriptions have been deleted that the
+      ///< index should be cleared and built again.
+};
+
+// --- cSimilarityIndex ----------------------------------------------------------
+
+// Finds candidates for "descriptions are similar" with MinHash signatures of
+// the descriptions' shingles (overlapping character sequences). The share of
+// equal signature values estimates the Jaccard similarity of the shingle
+// sets. The signatures are split into bands, and descriptions that have the
+// same values in any band become candidates (locality-sensitive hashing).
+// The number of rows per band follows the threshold, so that pairs above it
+// are found with high probability.
+
+class cSimilarityIndex {
+private:
+  int rows;
+  std::vector<uint32_t> signatures; // K values per id
+  std::vector<char> indexed;
+  std::unordered_map<uint64_t, std::vector<int> > buckets;
+  uint64_t Bucket(int Id, int Band) const;
+  static void Erase(std::vector<int> &Ids, int Id);
+public:
+  enum { K = 64, SHINGLE = 5 };
+  cSimilarityIndex(void);
+  void Clear(int Threshold);
+      ///< Threshold is the similarity in percent that the candidates have to reach.
+  void Add(int Id, const char *Description, size_t Size);
+  void Del(int Id);
+  void Candidates(int Id, std::vector<int> &Ids) const;
+      ///< Appends the candidates of Id to Ids.
+  int Similarity(int Id1, int Id2) const;
+      ///< Returns the estimated similarity of the two descriptions in percent.
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * journal.c: Central store for the hidden state of recordings.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "journal.h"
+#include <vdr/plugin.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// --- cHiddenJournal ------------------------------------------------------------
+
+cHiddenJournal::cHiddenJournal(void) {
+  f = NULL;
+  records = 0;
+}
+
+cHiddenJournal::~cHiddenJournal() {
+  Close();
+}
+
+bool cHiddenJournal::Open(bool Create) {
+  Close();
+  fileName = AddDirectory(cPlugin::ConfigDirectory(PLUGIN_NAME_I18N), "hidden.journal");
+  bool exists = access(fileName, F_OK) == 0;
+  if (!exists && !Create)
+    return false;
+  if (exists) {
+    FILE *r = fopen(fileName, "r");
+    if (!r) {
+      LOG_ERROR_STR(*fileName);
+      return true;
+    }
+    char *buffer = NULL;
+    size_t size = 0;
+    ssize_t n;
+    off_t valid = 0;
+    while ((n = getline(&buffer, &size, r)) > 0) {
+      if (buffer[n - 1] != '\n')
+        break; // incomplete last line
+      valid += n;
+      buffer[n - 1] = 0;
+      if (*buffer == '+')
+        hidden.insert(buffer + 1);
+      else if (*buffer == '-')
+        hidden.erase(buffer + 1);
+      else
+        continue;
+      records++;
+    }
+    free(buffer);
+    fclose(r);
+    if (n > 0 && truncate(fileName, valid) != 0)
+      LOG_ERROR_STR(*fileName);
+  }
+  f = fopen(fileName, "a");
+  if (!f)
+    LOG_ERROR_STR(*fileName);
+  dsyslog("duplicates: Loaded %d hidden recordings from %d journal records.", (int)hidden.size(), records);
+  return exists;
+}
+
+void cHiddenJournal::Close(void) {
+  if (f)
+    fclose(f);
+  f = NULL;
+  records = 0;
+  hidden.clear();
+}
+
+bool cHiddenJournal::Append(char Op, const char *FileName) {
+  if (!f)
+    return false;
+  if (fprintf(f, "%c%s\n", Op, FileName) < 0 || fflush(f) != 0 || fdatasync(fileno(f)) != 0) {
+    LOG_ERROR_STR(*fileName);
+    return false;
+  }
+  records++;
+  return true;
+}
+
+bool cHiddenJournal::Set(const char *FileName, bool Hidden) {
+  if (!Append(Hidden ? '+' : '-', FileName))
+    return false;
+  if (Hidden)
+    hidden.insert(FileName);
+  else
+    hidden.erase(FileName);
+  return true;
+}
+
+bool cHiddenJournal::Rewrite(const std::vector<const char *> &Hidden) {
+  if (!f)
+    return false;
+  cString tempName = cString::sprintf("%s.tmp", *fileName);
+  FILE *t = fopen(tempName, "w");
+  if (!t) {
+    LOG_ERROR_STR(*tempName);
+    return false;
+  }
+  std::unordered_set<std::string> written;
+  bool ok = true;
+  for (std::vector<const char *>::const_iterator n = Hidden.begin(); ok && n != Hidden.end(); ++n) {
+    if (written.insert(*n).second)
+      ok = fprintf(t, "+%s\n", *n) >= 0;
+  }
+  if (ok)
+    ok = fflush(t) == 0 && fsync(fileno(t)) == 0;
+  if (fclose(t) != 0)
+    ok = false;
+  if (ok && rename(tempName, fileName) == 0) {
+    // make the rename itself durable
+    int d = open(cPlugin::ConfigDirectory(PLUGIN_NAME_I18N), O_RDONLY | O_DIRECTORY);
+    if (d >= 0) {
+      fsync(d);
+      close(d);
+    }
+    fclose(f);
+    f = fopen(fileName, "a");
+    if (!f)
+      LOG_ERROR_STR(*fileName);
+    dsyslog("duplicates: Rewrote hidden journal from %d to %d records.", records, (int)written.size());
+    hidden.swap(written);
+    records = hidden.size();
+    return true;
+  }
+  LOG_ERROR_STR(*fileName);
+  remove(tempName);
+  return false;
+}
+
+bool cHiddenJournal::Compact(void) {
+  std::vector<const char *> keep;
+  keep.reserve(hidden.size());
+  for (std::unordered_set<std::string>::const_iterator h = hidden.begin(); h != hidden.end(); ++h)
+    keep.push_back(h->c_str());
+  return Rewrite(keep);
+}
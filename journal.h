@@ -0,0 +1,53 @@
+/*
+ * journal.h: Central store for the hidden state of recordings.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_JOURNAL_H
+#define _DUPLICATES_JOURNAL_H
+
+#include <vdr/tools.h>
+#include <stdio.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// --- cHiddenJournal ------------------------------------------------------------
+
+// Keeps the file names of the hidden recordings in one append-only file in
+// the plugin's config directory. Every change is appended as a line that
+// starts with '+' (hidden) or '-' (visible). An incomplete last line is
+// ignored, so an interrupted write loses at most that one change.
+
+class cHiddenJournal {
+private:
+  cString fileName;
+  FILE *f;
+  int records;
+  std::unordered_set<std::string> hidden;
+  bool Append(char Op, const char *FileName);
+public:
+  cHiddenJournal(void);
+  ~cHiddenJournal();
+  bool Open(bool Create = true);
+      ///< Loads the journal. Returns false if there is none yet, in which case
+      ///< an empty one is only created if Create is true.
+  void Close(void);
+  bool IsOpen(void) const { return f != NULL; }
+  bool Hidden(const std::string &FileName) const { return hidden.find(FileName) != hidden.end(); }
+  const std::unordered_set<std::string> &HiddenRecordings(void) const { return hidden; }
+  bool Set(const char *FileName, bool Hidden);
+  bool Rewrite(const std::vector<const char *> &Hidden);
+      ///< Replaces the journal atomically with one that contains exactly the
+      ///< given hidden recordings.
+  bool Compact(void);
+      ///< Rewrites the journal with one record per hidden recording. Hidden
+      ///< recordings that are missing right now, e.g. on a disk that isn't
+      ///< mounted, are kept.
+  bool NeedsCompaction(void) const { return records > 2 * (int)hidden.size() + 64; }
+};
+
+#endif
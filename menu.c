@@ -9,14 +9,21 @@
  */
 
 #include "menu.h"
+#include "actions.h"
+#include "fingerprint.h"
 #include "visibility.h"
 #include <vdr/menu.h>
 #include <vdr/status.h>
 #include <vdr/interface.h>
 #include <vdr/svdrp.h>
+#include <algorithm>
+
+static inline cString SeparatorText(const char *Label) {
+  return cString::sprintf("----- %s -----", Label);
+}
 
 static inline cOsdItem *SeparatorItem(const char *Label) {
-  cOsdItem *Item = new cOsdItem(cString::sprintf("----- %s -----", Label));
+  cOsdItem *Item = new cOsdItem(SeparatorText(Label));
   Item->SetSelectable(false);
   return Item;
 }
@@ -118,16 +125,46 @@ eOSState cMenuDuplicate::ProcessKey(eKeys Key) {
 class cMenuDuplicateItem : public cOsdItem {
 private:
   std::string fileName;
+  std::string text;
+  bool marking;
+  bool marked;
   cVisibility visibility;
 public:
-  cMenuDuplicateItem(cDuplicateRecording *DuplicateRecording);
+  cMenuDuplicateItem(const cDuplicateRecording *DuplicateRecording);
+  virtual void Set(void);
+  bool Update(const cDuplicateRecording *DuplicateRecording);
+  void SetMark(bool Marking, bool Marked);
   const char *FileName(void) { return fileName.c_str(); }
   cVisibility Visibility() { return visibility; }
 };
 
-cMenuDuplicateItem::cMenuDuplicateItem(cDuplicateRecording *DuplicateRecording) : visibility(DuplicateRecording->Visibility()) {
+cMenuDuplicateItem::cMenuDuplicateItem(const cDuplicateRecording *DuplicateRecording) : visibility(DuplicateRecording->Visibility()) {
   fileName = DuplicateRecording->FileName();
-  SetText(DuplicateRecording->Text().c_str());
+  text = DuplicateRecording->Text();
+  marking = marked = false;
+  Set();
+}
+
+void cMenuDuplicateItem::Set(void) {
+  if (marking)
+    SetText(cString::sprintf("%s\t%s", marked ? "*" : " ", text.c_str()));
+  else
+    SetText(text.c_str());
+}
+
+bool cMenuDuplicateItem::Update(const cDuplicateRecording *DuplicateRecording) {
+  visibility = DuplicateRecording->Visibility();
+  if (DuplicateRecording->Text() == text)
+    return false;
+  text = DuplicateRecording->Text();
+  Set();
+  return true;
+}
+
+void cMenuDuplicateItem::SetMark(bool Marking, bool Marked) {
+  marking = Marking;
+  marked = Marked;
+  Set();
 }
 
 // --- cMenuDuplicates -------------------------------------------------------
@@ -136,7 +173,11 @@ cMenuDuplicates::cMenuDuplicates()
 :cOsdMenu(tr("Duplicate recordings"), 9, 7, 7)
 {
   SetMenuCategory(mcRecording);
+  generation = -1;
   helpKeys = -1;
+  firstRow = 0;
+  marking = false;
+  deleting = false;
   Set();
   Display();
   SetHelpKeys();
@@ -149,7 +190,9 @@ cMenuDuplicates::~cMenuDuplicates() {
 void cMenuDuplicates::SetHelpKeys(void) {
   cMenuDuplicateItem *ri = (cMenuDuplicateItem *)Get(Current());
   int NewHelpKeys = 0;
-  if (ri) {
+  if (marking)
+    NewHelpKeys = 3;
+  else if (ri) {
     NewHelpKeys = 1;
     if (ri->Visibility().Read() == HIDDEN)
       NewHelpKeys = 2;
@@ -158,39 +201,230 @@ void cMenuDuplicates::SetHelpKeys(void) {
     switch (NewHelpKeys) {
       case 0: SetHelp(NULL); break;
       case 1:
-      case 2: SetHelp(trVDR("Button$Play"), trVDR("Setup"), trVDR("Button$Delete"), NewHelpKeys == 1 ? tr("Hide") : tr("Unhide"));
+      case 2: SetHelp(trVDR("Button$Play"), trVDR("Setup"), trVDR("Button$Delete"), NewHelpKeys == 1 ? tr("Hide") : tr("Unhide")); break;
+      case 3: SetHelp(tr("Select"), tr("Unmark"), trVDR("Button$Delete"), tr("Hide")); break;
       default: ;
     }
     helpKeys = NewHelpKeys;
   }
 }
 
-void cMenuDuplicates::Set(bool Refresh) {
-  if (DuplicateRecordings.Lock(duplicateRecordingsStateKey)) {
-    dsyslog("duplicates: %s menu.", Refresh ? "Refreshing" : "Creating");
-    const char *CurrentRecording = NULL;
-    int currentIndex = -1;
-    if (Refresh)
-      currentIndex = Current();
+// The menu is a list of rows, each group separator followed by the rows of
+// its recordings. Only the rows around the current one are turned into items,
+// the first of them being firstRow, so large lists open without delay.
+
+int cMenuDuplicates::PageSize(void) {
+  cSkinDisplayMenu *displayMenu = DisplayMenu();
+  int pageSize = displayMenu ? displayMenu->MaxItems() : 0;
+  return pageSize > 0 ? pageSize : MENUPAGESIZE;
+}
+
+int cMenuDuplicates::RowRecording(int Row, int &Group) {
+  // the group of Row is the last one starting at or before it
+  int low = 0, high = duplicateGeneration->Groups();
+  while (high - low > 1) {
+    int middle = (low + high) / 2;
+    if (middle + duplicateGeneration->FirstRecording(middle) <= Row)
+      low = middle;
     else
-      CurrentRecording = cReplayControl::LastReplayed();
-    Clear();
-    for (cDuplicateRecording *Duplicates = DuplicateRecordings.First(); Duplicates; Duplicates = DuplicateRecordings.Next(Duplicates)) {
-      Add(SeparatorItem(Duplicates->Text().c_str()));
-      for (cDuplicateRecording *Duplicate = Duplicates->Duplicates()->First(); Duplicate; Duplicate = Duplicates->Duplicates()->Next(Duplicate)) {
-        cMenuDuplicateItem *Item = new cMenuDuplicateItem(Duplicate);
-        Add(Item);
-        if (CurrentRecording && strcmp(CurrentRecording, Item->FileName()) == 0)
-          SetCurrent(Item);
+      high = middle;
+  }
+  Group = low;
+  int recording = Row - low - 1;
+  return recording < duplicateGeneration->FirstRecording(low) ? -1 : recording;
+}
+
+cOsdItem *cMenuDuplicates::RowItem(int Row) {
+  int group;
+  int recording = RowRecording(Row, group);
+  if (recording < 0)
+    return SeparatorItem(duplicateGeneration->GroupText(group));
+  cMenuDuplicateItem *item = new cMenuDuplicateItem(duplicateGeneration->Recording(recording));
+  if (marking)
+    item->SetMark(true, marked.count(item->FileName()) > 0);
+  return item;
+}
+
+void cMenuDuplicates::Materialize(int From, int To) {
+  From = std::max(From, 0);
+  To = std::min(To, Rows());
+  if (Count() == 0)
+    firstRow = From;
+  int lastRow = firstRow + Count();
+  if (From < firstRow) {
+    cOsdItem *current = Get(Current());
+    for (int row = firstRow - 1; row >= From; row--)
+      Ins(RowItem(row));
+    firstRow = From;
+    if (current)
+      SetCurrent(current);
+  }
+  for (int row = lastRow; row < To; row++)
+    Add(RowItem(row));
+}
+
+void cMenuDuplicates::SetWindow(int Row) {
+  Clear();
+  firstRow = 0;
+  int rows = Rows();
+  if (rows == 0) {
+    Add(SeparatorItem(cString::sprintf(tr("%d duplicate recordings"), 0)));
+    return;
+  }
+  int pageSize = PageSize();
+  int from = std::min(std::max(Row, 0) - MENULOOKAHEAD * pageSize, rows - (2 * MENULOOKAHEAD + 1) * pageSize);
+  Materialize(from, from + (2 * MENULOOKAHEAD + 1) * pageSize);
+  if (Row >= 0)
+    SetCurrentIndex(Row - firstRow);
+}
+
+bool cMenuDuplicates::Scroll(eKeys Key) {
+  int rows = Rows();
+  if (Count() >= rows || Current() < 0)
+    return false;
+  int row = firstRow + Current();
+  bool up = Key == kUp || Key == kLeft;
+  if (::Setup.MenuScrollWrap && (up ? row == 1 : row == rows - 1)) {
+    // wrap around the whole list instead of the items at hand
+    SetWindow(up ? rows - 1 : 0);
+    Display();
+    return true;
+  }
+  int pageSize = PageSize();
+  int from = row - pageSize - 1;
+  int to = row + pageSize + 2;
+  if (firstRow > 0 && from < firstRow) {
+    // items inserted on top move the display, so insert several pages at once
+    Materialize(from - MENULOOKAHEAD * pageSize, to);
+    Display();
+  }
+  if (to > firstRow + Count())
+    Materialize(from, to + MENULOOKAHEAD * pageSize);
+  return false;
+}
+
+bool cMenuDuplicates::Update(void) {
+  // keep the cursor on the current recording, or the nearest one that is left
+  int current = Current();
+  int anchor = -1;
+  int anchorRow = -1;
+  for (int i = 0; current >= 0 && anchorRow < 0 && i < 2 * Count(); i++) {
+    int index = i < Count() ? current + i : current - (i - Count()) - 1;
+    cOsdItem *item = Get(index);
+    if (item && item->Selectable()) {
+      int recording = duplicateGeneration->Find(((cMenuDuplicateItem *)item)->FileName());
+      if (recording >= 0) {
+        anchor = index;
+        anchorRow = Row(recording);
+      }
+    }
+  }
+  int rows = Rows();
+  if (anchorRow < 0) {
+    anchor = std::max(current, 0);
+    anchorRow = std::min(firstRow + anchor, rows - 1);
+  }
+  // the rows to show, at the same position relative to the cursor as before
+  int from = anchorRow - anchor;
+  int to = from + Count();
+  if (to > rows) {
+    from -= to - rows;
+    to = rows;
+  }
+  from = std::max(from, 0);
+  std::unordered_map<const char *, cOsdItem *, cFileNameHash, cFileNameEqual> items;
+  for (cOsdItem *item = First(); item; item = Next(item)) {
+    if (item->Selectable())
+      items[((cMenuDuplicateItem *)item)->FileName()] = item;
+  }
+  // walk both lists, keeping what is unchanged and replacing the rest
+  int changes = 0;
+  cOsdItem *currentItem = NULL;
+  cOsdItem *item = First();
+  for (int row = from; row < to; row++) {
+    int group;
+    int recording = RowRecording(row, group);
+    cOsdItem *rowItem = NULL;
+    if (recording < 0) {
+      if (item && !item->Selectable()) {
+        cString text = SeparatorText(duplicateGeneration->GroupText(group));
+        if (strcmp(item->Text(), text) != 0) {
+          item->SetText(text);
+          changes++;
+        }
+        rowItem = item;
+        item = Next(item);
+      }
+    } else {
+      const cDuplicateRecording *duplicateRecording = duplicateGeneration->Recording(recording);
+      std::unordered_map<const char *, cOsdItem *, cFileNameHash, cFileNameEqual>::iterator i = items.find(duplicateRecording->FileName().c_str());
+      if (i != items.end()) {
+        rowItem = i->second;
+        items.erase(i);
+        // whatever comes before the recording in the old list is gone or has moved
+        while (item != rowItem) {
+          cOsdItem *next = Next(item);
+          if (item->Selectable())
+            items.erase(((cMenuDuplicateItem *)item)->FileName());
+          cList<cOsdItem>::Del(item);
+          changes++;
+          item = next;
+        }
+        if (((cMenuDuplicateItem *)rowItem)->Update(duplicateRecording))
+          changes++;
+        item = Next(item);
       }
     }
-    duplicateRecordingsStateKey.Remove();
-    if (Count() == 0)
-      Add(SeparatorItem(cString::sprintf(tr("%d duplicate recordings"), 0)));
+    if (!rowItem) {
+      rowItem = RowItem(row);
+      if (item)
+        Ins(rowItem, false, item);
+      else
+        Add(rowItem);
+      changes++;
+    }
+    if (row == anchorRow)
+      currentItem = rowItem;
+  }
+  while (item) {
+    cOsdItem *next = Next(item);
+    cList<cOsdItem>::Del(item);
+    changes++;
+    item = next;
+  }
+  firstRow = from;
+  SetCurrentIndex(currentItem ? currentItem->Index() : anchorRow - from);
+  return changes > 0;
+}
+
+void cMenuDuplicates::Set(bool Refresh) {
+  std::shared_ptr<const cDuplicateGeneration> DuplicateGeneration = DuplicateRecordings.Get();
+  if (DuplicateGeneration->Generation() != generation) {
+    generation = DuplicateGeneration->Generation();
+    dsyslog("duplicates: %s menu.", Refresh ? "Refreshing" : "Creating");
+    bool hadRows = duplicateGeneration && Rows() > 0;
+    duplicateGeneration = DuplicateGeneration;
+    if (Refresh && hadRows && Rows() > 0) {
+      if (Update())
+        Display();
+      return;
+    }
+    int currentRow = -1;
     if (Refresh) {
-      SetCurrentIndex(currentIndex);
-      Display();    
+      if (Current() >= 0)
+        currentRow = firstRow + Current();
+    } else {
+      // keeps the current recording, e.g. after a setup change, or else
+      // selects the last replayed one
+      cMenuDuplicateItem *currentItem = (cMenuDuplicateItem *)Get(Current());
+      const char *CurrentRecording = currentItem ? currentItem->FileName() : cReplayControl::LastReplayed();
+      int recording = CurrentRecording ? duplicateGeneration->Find(CurrentRecording) : -1;
+      if (recording >= 0)
+        currentRow = Row(recording);
     }
+    SetWindow(currentRow);
+    if (Refresh)
+      Display();
   }
 }
 
@@ -203,6 +437,14 @@ static bool HandleRemoteModifications(cTimer *NewTimer, cTimer *OldTimer = NULL)
   return true;
 }
 
+static void StopReplay(const std::vector<std::string> &FileNames) {
+  // a replay of a recording that is deleted is stopped, as in VDR's recordings menu
+  if (const char *NowReplaying = cReplayControl::NowReplaying()) {
+    if (std::find(FileNames.begin(), FileNames.end(), NowReplaying) != FileNames.end())
+      cControl::Shutdown();
+  }
+}
+
 static bool TimerStillRecording(const char *FileName) {
   if (cRecordControl *rc = cRecordControls::GetRecordControl(FileName)) {
     // local timer
@@ -256,16 +498,154 @@ void cMenuDuplicates::SetCurrentIndex(int index) {
     if (index >= Count())
       index = Count() - 1;
     cOsdItem *current = Get(index);
-    while (current) {
-      if (current->Selectable()) {
-        SetCurrent(current);
-        break;
-      }
+    while (current && !current->Selectable())
       current = Prev(current);
+    if (!current) {
+      current = Get(index);
+      while (current && !current->Selectable())
+        current = Next(current);
+    }
+    if (current)
+      SetCurrent(current);
+  }
+}
+
+// In marking mode any number of recordings can be marked and then deleted
+// or hidden at once. The marks are kept by file name, so they survive
+// scrolling and refreshes.
+
+void cMenuDuplicates::SetMarking(bool Marking) {
+  marking = Marking;
+  marked.clear();
+  if (marking)
+    SetCols(2, 9, 7, 7);
+  else
+    SetCols(9, 7, 7);
+  for (cOsdItem *item = First(); item; item = Next(item)) {
+    if (item->Selectable())
+      ((cMenuDuplicateItem *)item)->SetMark(marking, false);
+  }
+  Display();
+}
+
+std::vector<std::string> cMenuDuplicates::Marked(void) {
+  std::vector<std::string> FileNames;
+  for (std::set<std::string>::const_iterator fileName = marked.begin(); fileName != marked.end(); ++fileName) {
+    if (duplicateGeneration->Find(fileName->c_str()) >= 0)
+      FileNames.push_back(*fileName);
+  }
+  return FileNames;
+}
+
+eOSState cMenuDuplicates::ToggleMark(void) {
+  if (cMenuDuplicateItem *ri = (cMenuDuplicateItem *)Get(Current())) {
+    bool mark = marked.insert(ri->FileName()).second;
+    if (!mark)
+      marked.erase(ri->FileName());
+    ri->SetMark(true, mark);
+    DisplayCurrent(true);
+  }
+  return osContinue;
+}
+
+eOSState cMenuDuplicates::SelectDuplicates(void) {
+  // marks all recordings of each group but the one to keep
+  std::vector<long> values(duplicateGeneration->Recordings(), -1); // -1 if the recording is gone
+  cStateKey stateKey;
+  const cRecordings *Recordings = cRecordings::GetRecordingsRead(stateKey);
+  std::unordered_map<const char *, const cRecording *, cFileNameHash, cFileNameEqual> recordings;
+  for (const cRecording *recording = Recordings->First(); recording; recording = Recordings->Next(recording))
+    recordings[recording->FileName()] = recording;
+  for (int r = 0; r < duplicateGeneration->Recordings(); r++) {
+    if (!duplicateGeneration->IsDuplicates(duplicateGeneration->Group(r)))
+      continue;
+    std::unordered_map<const char *, const cRecording *, cFileNameHash, cFileNameEqual>::const_iterator recording = recordings.find(duplicateGeneration->FileName(r));
+    if (recording != recordings.end())
+      values[r] = recording->second->Start();
+  }
+  stateKey.Remove();
+  if (dc.keep == kpLargest) {
+    // the sizes measured by the scanner, the others are measured without
+    // holding the lock
+    for (int r = 0; r < duplicateGeneration->Recordings(); r++) {
+      if (values[r] < 0)
+        continue;
+      int size = duplicateGeneration->Recording(r)->FileSizeMB();
+      if (size < 0) {
+        int length;
+        Measure(duplicateGeneration->FileName(r), 0, length, size);
+      }
+      values[r] = size;
+    }
+  }
+  for (int group = 0; group < duplicateGeneration->Groups(); group++) {
+    if (!duplicateGeneration->IsDuplicates(group))
+      continue;
+    int first = duplicateGeneration->FirstRecording(group);
+    int last = group + 1 < duplicateGeneration->Groups() ? duplicateGeneration->FirstRecording(group + 1) : duplicateGeneration->Recordings();
+    int keep = -1;
+    for (int r = first; r < last; r++) {
+      if (values[r] >= 0 && (keep < 0 || values[r] > values[keep]))
+        keep = r;
     }
+    for (int r = first; r < last; r++) {
+      if (r != keep && values[r] >= 0)
+        marked.insert(duplicateGeneration->FileName(r));
+    }
+  }
+  for (cOsdItem *item = First(); item; item = Next(item)) {
+    if (item->Selectable())
+      ((cMenuDuplicateItem *)item)->SetMark(true, marked.count(((cMenuDuplicateItem *)item)->FileName()) > 0);
+  }
+  Display();
+  return osContinue;
+}
+
+void cMenuDuplicates::ShowProgress(void) {
+  int done, total;
+  if (DuplicateDeleter.Progress(done, total)) {
+    SetStatus(cString::sprintf(tr("Deleting recordings (%d/%d)"), done, total));
+    deleting = true;
+  } else if (deleting) {
+    SetStatus(NULL);
+    deleting = false;
   }
 }
 
+eOSState cMenuDuplicates::DeleteMarked(void) {
+  std::vector<std::string> FileNames = Marked();
+  if (FileNames.empty() || !Interface->Confirm(cString::sprintf(tr("Delete %d recordings?"), int(FileNames.size()))))
+    return osContinue;
+  // recordings that are still being recorded or edited are left alone
+  std::vector<std::string> deletable;
+  for (std::vector<std::string>::const_iterator fileName = FileNames.begin(); fileName != FileNames.end(); ++fileName) {
+    if (!cRecordControls::GetRecordControl(fileName->c_str()) && !*GetRecordingTimerId(fileName->c_str()) && !RecordingsHandler.GetUsage(fileName->c_str()))
+      deletable.push_back(*fileName);
+  }
+  StopReplay(deletable);
+  DuplicateDeleter.Delete(deletable);
+  SetMarking(false);
+  Set(true);
+  SetHelpKeys();
+  ShowProgress();
+  if (deletable.size() < FileNames.size())
+    Skins.Message(mtWarning, cString::sprintf(tr("%d recordings in use were skipped"), int(FileNames.size() - deletable.size())));
+  return osContinue;
+}
+
+eOSState cMenuDuplicates::HideMarked(void) {
+  std::vector<std::string> FileNames = Marked();
+  if (FileNames.empty() || !Interface->Confirm(cString::sprintf(tr("Hide %d recordings?"), int(FileNames.size()))))
+    return osContinue;
+  int hidden = SetHidden(FileNames, true);
+  SetMarking(false);
+  Set(true);
+  SetHelpKeys();
+  if (hidden < int(FileNames.size()))
+    Skins.Message(mtError, tr("Error while setting visibility!"));
+  return osContinue;
+}
+
 eOSState cMenuDuplicates::Delete(void) {
   if (HasSubMenu() || Count() == 0)
     return osContinue;
@@ -280,26 +660,12 @@ eOSState cMenuDuplicates::Delete(void) {
         } else
           return osContinue;
       }
-      dsyslog("duplicates: Deleting recording %s.", FileName);
-      if (cReplayControl::NowReplaying() && strcmp(cReplayControl::NowReplaying(), FileName) == 0)
-         cControl::Shutdown();
-      cStateKey recordingsStateKey;
-      cRecordings *Recordings = cRecordings::GetRecordingsWrite(recordingsStateKey);
-      Recordings->SetExplicitModify();
-      cRecording *recording = Recordings->GetByName(FileName);
-      if (!recording || recording->Delete()) {
-        cReplayControl::ClearLastReplayed(FileName);
-        Recordings->DelByName(FileName);
-        cVideoDiskUsage::ForceCheck();
-        Recordings->SetModified();
-        recordingsStateKey.Remove();
-        DuplicateRecordings.Remove(std::string(FileName));
-        Set(true);
-        SetHelpKeys();
-      } else {
-        recordingsStateKey.Remove();
-        Skins.Message(mtError, trVDR("Error while deleting recording!"));
-      }
+      std::vector<std::string> FileNames(1, FileName);
+      StopReplay(FileNames);
+      DuplicateDeleter.Delete(FileNames);
+      Set(true);
+      SetHelpKeys();
+      ShowProgress();
     }
   }
   return osContinue;
@@ -358,11 +724,9 @@ eOSState cMenuDuplicates::ToggleHidden(void) {
   if (ri) {
     bool hidden = ri->Visibility().Read() == HIDDEN;
     if (Interface->Confirm(hidden ? tr("Unhide recording?") : tr("Hide recording?"))) {
-      if (ri->Visibility().Write(hidden)) {
-        if (!dc.hidden) {
-          DuplicateRecordings.Remove(std::string(ri->FileName()));
+      if (SetHidden(ri->FileName(), !hidden)) {
+        if (!dc.hidden)
           Set(true);
-        }
         SetHelpKeys();
       } else
         Skins.Message(mtError, tr("Error while setting visibility!"));
@@ -372,8 +736,47 @@ eOSState cMenuDuplicates::ToggleHidden(void) {
 }
 
 eOSState cMenuDuplicates::ProcessKey(eKeys Key) {
+  if (!HasSubMenu()) {
+    switch (int(Key)) {
+      case kUp|k_Repeat:
+      case kUp:
+      case kDown|k_Repeat:
+      case kDown:
+      case kLeft|k_Repeat:
+      case kLeft:
+      case kRight|k_Repeat:
+      case kRight:
+                    if (Scroll(NORMALKEY(Key))) {
+                      SetHelpKeys();
+                      return osContinue;
+                    }
+                    break;
+      case kBack:   if (marking) {
+                      SetMarking(false);
+                      SetHelpKeys();
+                      return osContinue;
+                    }
+                    break;
+      default: break;
+    }
+  }
+
   eOSState state = cOsdMenu::ProcessKey(Key);
 
+  if (state == osUnknown && marking) {
+    switch (Key) {
+      case kRed:    return SelectDuplicates();
+      case kGreen:  SetMarking(true);
+                    return osContinue;
+      case kYellow: return DeleteMarked();
+      case kBlue:   return HideMarked();
+      case kOk:     return ToggleMark();
+      case k0:      SetMarking(false);
+                    state = osContinue;
+                    break;
+      default: break;
+    }
+  }
   if (state == osUnknown) {
     switch (Key) {
       case kPlay:
@@ -383,7 +786,11 @@ eOSState cMenuDuplicates::ProcessKey(eKeys Key) {
       case kOk:
       case kInfo:   return Info();
       case kBlue:   return ToggleHidden();
+      case k0:      SetMarking(true);
+                    state = osContinue;
+                    break;
       case kNone:   Set(true);
+                    ShowProgress();
                     break;
       default: break;
     }
@@ -402,14 +809,27 @@ cMenuSetupDuplicates::cMenuSetupDuplicates(cMenuDuplicates *MenuDuplicates) {
   menuDuplicates = MenuDuplicates;
   Add(new cMenuEditBoolItem(tr("Compare title"), &dc.title));
   Add(new cMenuEditBoolItem(tr("Show hidden"), &dc.hidden));
+  Add(new cMenuEditBoolItem(tr("Keep hidden state in config directory"), &dc.journal));
+  Add(new cMenuEditBoolItem(tr("Ignore whitespace"), &dc.whitespace));
+  Add(new cMenuEditBoolItem(tr("Ignore punctuation"), &dc.punctuation));
+  Add(new cMenuEditBoolItem(tr("Ignore case"), &dc.casefold));
+  Add(new cMenuEditBoolItem(tr("Compare umlauts as ae, oe, ue"), &dc.umlauts));
+  Add(new cMenuEditIntItem(tr("Similar descriptions (%)"), &dc.similarity, 0, MAXSIMILARITY, tr("off")));
+  Add(new cMenuEditBoolItem(tr("Compare content without description"), &dc.fingerprint));
+  Add(new cMenuEditIntItem(tr("Length tolerance (min)"), &dc.lengthtolerance, 0, MAXLENGTHTOLERANCE, tr("off")));
+  Add(new cMenuEditIntItem(tr("Size tolerance (%)"), &dc.sizetolerance, 0, MAXSIZETOLERANCE, tr("off")));
+  keepTexts[kpNewest] = tr("newest");
+  keepTexts[kpLargest] = tr("largest");
+  Add(new cMenuEditStraItem(tr("Keep when selecting"), &dc.keep, kpCount, keepTexts));
+  Add(new cMenuEditIntItem(tr("Comparison threads"), &dc.threads, 1, MAXCOMPARETHREADS));
+  Add(new cMenuEditIntItem(tr("Scan delay (ms)"), &dc.delay, 0, MAXSCANDELAY));
 }
 
 void cMenuSetupDuplicates::Store(void) {
   dc.Store();
-  if (menuDuplicates != NULL) {
-    menuDuplicates->SetCurrent(NULL);
+  DuplicateRecordingScanner.Trigger();
+  if (menuDuplicates != NULL)
     menuDuplicates->Set();
-  }
 }
 
 void cMenuSetupDuplicates::SetTitle(const char *Title) {
@@ -17,6 +17,12 @@
 #include <vdr/videodir.h>
 #include "config.h"
 #include "recording.h"
+#include <set>
+#include <string>
+#include <vector>
+
+#define MENUPAGESIZE  20 // items per page until the skin reports its own
+#define MENULOOKAHEAD 2  // pages kept as items before and after the current one
 
 class cMenuSetupDuplicates;
 
@@ -25,11 +31,32 @@ class cMenuSetupDuplicates;
 class cMenuDuplicates : public cOsdMenu {
   friend class cMenuSetupDuplicates;
 private:
-  cStateKey duplicateRecordingsStateKey;
+  int generation;
   int helpKeys;
+  std::shared_ptr<const cDuplicateGeneration> duplicateGeneration;
+  int firstRow;
+  bool marking;
+  std::set<std::string> marked;
+  bool deleting;
+  int PageSize(void);
+  int Rows(void) { return duplicateGeneration->Groups() + duplicateGeneration->Recordings(); }
+  int Row(int Recording) { return Recording + duplicateGeneration->Group(Recording) + 1; }
+  int RowRecording(int Row, int &Group);
+  cOsdItem *RowItem(int Row);
+  void Materialize(int From, int To);
+  void SetWindow(int Row);
+  bool Scroll(eKeys Key);
+  bool Update(void);
   void SetHelpKeys(void);
   void Set(bool Refresh = false);
   void SetCurrentIndex(int index);
+  void SetMarking(bool Marking);
+  void ShowProgress(void);
+  std::vector<std::string> Marked(void);
+  eOSState ToggleMark(void);
+  eOSState SelectDuplicates(void);
+  eOSState DeleteMarked(void);
+  eOSState HideMarked(void);
   eOSState Play(void);
   eOSState Setup(void);
   eOSState Delete(void);
@@ -46,6 +73,7 @@ public:
 class cMenuSetupDuplicates : public cMenuSetupPage {
 private:
   cMenuDuplicates *menuDuplicates;
+  const char *keepTexts[kpCount];
 protected:
   virtual void Store(void);
 public:
@@ -0,0 +1,92 @@
+/*
+ * normalize.c: Text normalization for duplicate detection.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "normalize.h"
+#include <string.h>
+
+// --- cNormalizer ---------------------------------------------------------------
+
+cNormalizer::cNormalizer(void) {
+  buffer.reserve(4096);
+}
+
+const std::string &cNormalizer::Normalize(int Flags, const char *Text1, const char *Text2) {
+  buffer.clear();
+  if (Text1)
+    Append(Flags, Text1);
+  if (Text2)
+    Append(Flags, Text2);
+  return buffer;
+}
+
+void cNormalizer::Append(int Flags, const char *Text) {
+  int flags = Flags;
+  const unsigned char *p = (const unsigned char *)Text;
+  while (*p) {
+    unsigned char c = *p;
+    if (c < 0x80) {
+      p++;
+      if ((c == ' ' || c == '|') && (flags & nmSeparators))
+        continue;
+      if ((c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') && (flags & nmWhitespace))
+        continue;
+      if ((flags & nmPunctuation) && c > ' ' && c < 0x7F && strchr("!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~", c))
+        continue;
+      if (c >= 'A' && c <= 'Z' && (flags & nmCase))
+        c += 'a' - 'A';
+      buffer += char(c);
+    } else if (c == 0xC2 && p[1]) {
+      // U+0080 - U+00BF
+      unsigned char c1 = p[1];
+      if (c1 == 0xA0 && (flags & nmWhitespace) || (c1 == 0xA1 || c1 == 0xAB || c1 == 0xB7 || c1 == 0xBB || c1 == 0xBF) && (flags & nmPunctuation)) {
+        p += 2;
+        continue;
+      }
+      buffer += char(c);
+      buffer += char(c1);
+      p += 2;
+    } else if (c == 0xC3 && p[1]) {
+      // U+00C0 - U+00FF
+      unsigned char c1 = p[1];
+      p += 2;
+      if (flags & nmUmlauts) {
+        const char *transliteration = NULL;
+        switch (c1) {
+          case 0x84: transliteration = flags & nmCase ? "ae" : "Ae"; break;
+          case 0x96: transliteration = flags & nmCase ? "oe" : "Oe"; break;
+          case 0x9C: transliteration = flags & nmCase ? "ue" : "Ue"; break;
+          case 0xA4: transliteration = "ae"; break;
+          case 0xB6: transliteration = "oe"; break;
+          case 0xBC: transliteration = "ue"; break;
+          case 0x9F: transliteration = "ss"; break;
+          default: break;
+        }
+        if (transliteration) {
+          buffer += transliteration;
+          continue;
+        }
+      }
+      if (c1 >= 0x80 && c1 <= 0x9E && c1 != 0x97 && (flags & nmCase))
+        c1 += 0x20;
+      buffer += char(c);
+      buffer += char(c1);
+    } else if (c == 0xE2 && p[1] == 0x80 && p[2]) {
+      // U+2000 - U+203F: spaces, dashes, quotation marks and ellipsis
+      unsigned char c2 = p[2];
+      if ((c2 <= 0x8A || c2 == 0xAF) && (flags & nmWhitespace) || (c2 >= 0x90 && c2 <= 0xA7 || c2 >= 0xB0 && c2 <= 0xBE) && (flags & nmPunctuation)) {
+        p += 3;
+        continue;
+      }
+      buffer.append((const char *)p, 3);
+      p += 3;
+    } else {
+      buffer += char(c);
+      p++;
+    }
+  }
+}
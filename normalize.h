@@ -0,0 +1,38 @@
+/*
+ * normalize.h: Text normalization for duplicate detection.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_NORMALIZE_H
+#define _DUPLICATES_NORMALIZE_H
+
+#include <string>
+
+// --- eNormalization ------------------------------------------------------------
+
+enum eNormalization {
+  nmSeparators  = 0x01, // remove ' ' and '|'
+  nmWhitespace  = 0x02, // remove all whitespace
+  nmPunctuation = 0x04, // remove punctuation
+  nmCase        = 0x08, // fold ASCII and Latin-1 letters to lower case
+  nmUmlauts     = 0x10, // write umlauts and 'ß' as "ae", "oe", "ue" and "ss"
+  };
+
+// --- cNormalizer ---------------------------------------------------------------
+
+// Normalizes UTF-8 text in one pass into a buffer that is reused for all
+// recordings.
+
+class cNormalizer {
+private:
+  std::string buffer;
+  void Append(int Flags, const char *Text);
+public:
+  cNormalizer(void);
+  const std::string &Normalize(int Flags, const char *Text1, const char *Text2 = NULL);
+};
+
+#endif
@@ -7,52 +7,40 @@
  */
 
 #include "config.h"
+#include "contains.h"
+#include "fingerprint.h"
+#include "index.h"
 #include "recording.h"
+#include <vdr/videodir.h>
 #include <sys/time.h>
-#include <sstream>
+#include <algorithm>
+#include <unordered_map>
 
 // --- cDuplicateRecording -------------------------------------------------------
 
-cDuplicateRecording::cDuplicateRecording(void) : visibility(NULL) {
+cDuplicateRecording::cDuplicateRecording(bool HasDescription) : visibility(NULL) {
+  hasDescription = HasDescription;
+  fileSize = -1;
   duplicates = new cList<cDuplicateRecording>;
 }
 
-cDuplicateRecording::cDuplicateRecording(const cRecording *Recording) : visibility(Recording->FileName()) {
-  checked = false;
-  fileName = std::string(Recording->FileName());
-  text = std::string(Recording->Title('\t', true));
-  if (dc.title && Recording->Info()->Title())
-     title = std::string(Recording->Info()->Title());
-  else
-     title = std::string();
-  std::stringstream desc;
-  if (Recording->Info()->ShortText())
-     desc << std::string(Recording->Info()->ShortText());
-  if (Recording->Info()->Description())
-     desc << std::string(Recording->Info()->Description());
-  description = desc.str();
-  while(true) {
-    size_t found = description.find("|");
-    if (found == std::string::npos)
-       break;
-    description.replace(found, 1, "");
-  }
-  while(true) {
-    size_t found = description.find(" ");
-    if (found == std::string::npos)
-       break;
-    description.replace(found, 1, "");
-  }
-  duplicates = NULL;
+cDuplicateRecording::cDuplicateRecording(const cRecordingTable &Table, int Id) :
+  hasDescription(Table.HasDescription(Id)),
+  visibility(Table.FileName(Id)),
+  fileName(Table.FileName(Id)),
+  text(Table.Text(Id)),
+  fileSize(Table.Flag(Id, rfMeasured) ? Table.FileSize(Id) : -1),
+  duplicates(NULL) {
+  if (Table.Flag(Id, rfVisibility))
+    visibility.Set(!Table.Flag(Id, rfHidden));
 }
 
 cDuplicateRecording::cDuplicateRecording(const cDuplicateRecording &DuplicateRecording) :
-  checked(DuplicateRecording.checked),
+  hasDescription(DuplicateRecording.hasDescription),
   visibility(DuplicateRecording.visibility),
   fileName(DuplicateRecording.fileName),
   text(DuplicateRecording.text),
-  title(DuplicateRecording.title),
-  description(DuplicateRecording.description) {
+  fileSize(DuplicateRecording.fileSize) {
   if (DuplicateRecording.duplicates != NULL && DuplicateRecording.duplicates->Count() > 0) {
     duplicates = new cList<cDuplicateRecording>;
     for (const cDuplicateRecording *duplicate = DuplicateRecording.duplicates->First(); duplicate; duplicate = DuplicateRecording.duplicates->Next(duplicate)) {
@@ -66,67 +54,208 @@ cDuplicateRecording::~cDuplicateRecording() {
   delete duplicates;
 }
 
+size_t cDuplicateRecording::MemoryUsage(void) const {
+  size_t size = sizeof(*this) + fileName.capacity() + text.capacity();
+  if (duplicates) {
+    size += sizeof(*duplicates);
+    for (const cDuplicateRecording *duplicate = duplicates->First(); duplicate; duplicate = duplicates->Next(duplicate))
+      size += duplicate->MemoryUsage();
+  }
+  return size;
+}
+
 bool cDuplicateRecording::HasDescription(void) const {
-  if (!description.empty())
+  if (hasDescription)
     return true;
   else if (duplicates && duplicates->First())
     return duplicates->First()->HasDescription();
   return false;
 }
 
-bool cDuplicateRecording::IsDuplicate(cDuplicateRecording *DuplicateRecording) {
-  if (!HasDescription() || !DuplicateRecording->HasDescription())
-    return false;
+// --- cDuplicateGeneration ------------------------------------------------------
 
-  size_t found;
-  if (dc.title) {
-    found = title.size() > DuplicateRecording->title.size() ?
-              title.find(DuplicateRecording->title) : DuplicateRecording->title.find(title);
-    if (found == std::string::npos)
-      return false;
+size_t cFileNameHash::operator()(const char *FileName) const {
+  // FNV-1a
+  size_t hash = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)FileName; *p; p++)
+    hash = (hash ^ *p) * 16777619u;
+  return hash;
+}
+
+void cDuplicateGeneration::Add(cDuplicateRecording *Group) {
+  groups.push_back(std::shared_ptr<const cDuplicateRecording>(Group));
+  indexed = false;
+}
+
+void cDuplicateGeneration::Index(void) {
+  recordings.clear();
+  recordingGroups.clear();
+  firstRecordings.clear();
+  removed.clear();
+  cDuplicateIndex *index = new cDuplicateIndex;
+  index->groups = groups;
+  for (size_t group = 0; group < groups.size(); group++) {
+    firstRecordings.push_back(recordings.size());
+    for (const cDuplicateRecording *duplicate = groups[group]->Duplicates()->First(); duplicate; duplicate = groups[group]->Duplicates()->Next(duplicate)) {
+      index->positions[duplicate->FileName().c_str()] = recordings.size();
+      recordings.push_back(duplicate);
+      recordingGroups.push_back(group);
+    }
+  }
+  this->index.reset(index);
+  indexed = true;
+}
+
+cDuplicateGeneration *cDuplicateGeneration::Remove(std::vector<int> Recordings) const {
+  std::sort(Recordings.begin(), Recordings.end());
+  Recordings.erase(std::unique(Recordings.begin(), Recordings.end()), Recordings.end());
+  // copy the groups concerned without the recordings, NULL if they are dissolved
+  std::vector<std::pair<int, cDuplicateRecording *> > changed;
+  std::vector<int> gone; // all recordings that are left out, also those of dissolved groups
+  for (std::vector<int>::const_iterator r = Recordings.begin(); r != Recordings.end();) {
+    int group = recordingGroups[*r];
+    int first = firstRecordings[group];
+    cDuplicateRecording *copy = new cDuplicateRecording(*groups[group]);
+    int position = 0;
+    std::vector<int>::size_type kept = gone.size();
+    for (cDuplicateRecording *d = copy->Duplicates()->First(); d; position++) {
+      cDuplicateRecording *duplicate = d;
+      d = copy->Duplicates()->Next(d);
+      if (r != Recordings.end() && *r == first + position) {
+        copy->Duplicates()->Del(duplicate);
+        gone.push_back(first + position);
+        ++r;
+      }
+    }
+    if (copy->Duplicates()->Count() < 2) {
+      delete copy;
+      copy = NULL;
+      gone.resize(kept);
+      for (int i = 0; i < groups[group]->Duplicates()->Count(); i++)
+        gone.push_back(first + i);
+    } else if (copy->HasDescription())
+      copy->SetText(std::string(cString::sprintf(tr("%d duplicate recordings"), copy->Duplicates()->Count())));
+    else
+      copy->SetText(std::string(cString::sprintf(tr("%d recordings without description"), copy->Duplicates()->Count())));
+    changed.push_back(std::make_pair(group, copy));
+  }
+  // Everything but the changed groups is shared. The file name index isn't
+  // touched, the recordings left out are only added to the sorted list of
+  // removed positions, which Find() skips and subtracts.
+  cDuplicateGeneration *generation = new cDuplicateGeneration;
+  generation->index = index;
+  std::vector<int> positions;
+  positions.reserve(gone.size());
+  std::vector<int>::const_iterator r = removed.begin();
+  int skipped = 0;
+  for (std::vector<int>::const_iterator g = gone.begin(); g != gone.end(); ++g) {
+    while (r != removed.end() && *r <= *g + skipped) {
+      ++r;
+      skipped++;
+    }
+    positions.push_back(*g + skipped);
+  }
+  generation->removed.resize(removed.size() + positions.size());
+  std::merge(removed.begin(), removed.end(), positions.begin(), positions.end(), generation->removed.begin());
+  generation->groups.reserve(groups.size());
+  generation->recordings.reserve(recordings.size() - gone.size());
+  generation->recordingGroups.reserve(recordings.size() - gone.size());
+  generation->firstRecordings.reserve(groups.size());
+  std::vector<std::pair<int, cDuplicateRecording *> >::const_iterator c = changed.begin();
+  for (size_t group = 0; group < groups.size(); group++) {
+    int newGroup = generation->groups.size();
+    if (c != changed.end() && c->first == int(group)) {
+      cDuplicateRecording *copy = (c++)->second;
+      if (!copy)
+        continue;
+      generation->groups.push_back(std::shared_ptr<const cDuplicateRecording>(copy));
+      generation->firstRecordings.push_back(generation->recordings.size());
+      for (const cDuplicateRecording *d = copy->Duplicates()->First(); d; d = copy->Duplicates()->Next(d)) {
+        generation->recordings.push_back(d);
+        generation->recordingGroups.push_back(newGroup);
+      }
+    } else {
+      generation->groups.push_back(groups[group]);
+      generation->firstRecordings.push_back(generation->recordings.size());
+      generation->recordings.insert(generation->recordings.end(), recordings.begin() + firstRecordings[group], recordings.begin() + firstRecordings[group] + groups[group]->Duplicates()->Count());
+      generation->recordingGroups.resize(generation->recordings.size(), newGroup);
+    }
   }
+  generation->indexed = true;
+  return generation;
+}
 
-  found = description.size() > DuplicateRecording->description.size() ?
-            description.find(DuplicateRecording->description) : DuplicateRecording->description.find(description);
-  if (found != std::string::npos)
-    return dc.hidden || visibility.Read() != HIDDEN && DuplicateRecording->visibility.Read() != HIDDEN;
+int cDuplicateGeneration::Find(const char *FileName) const {
+  if (!index)
+    return -1;
+  std::unordered_map<const char *, int, cFileNameHash, cFileNameEqual>::const_iterator i = index->positions.find(FileName);
+  if (i == index->positions.end())
+    return -1;
+  std::vector<int>::const_iterator r = std::lower_bound(removed.begin(), removed.end(), i->second);
+  if (r != removed.end() && *r == i->second)
+    return -1;
+  return i->second - (r - removed.begin());
+}
 
-  return false;
+size_t cDuplicateGeneration::MemoryUsage(void) const {
+  size_t size = sizeof(*this) + (groups.capacity() + recordings.capacity()) * sizeof(void *) + (recordingGroups.capacity() + firstRecordings.capacity()) * sizeof(int)
+                + removed.capacity() * sizeof(int);
+  if (index)
+    size += index->positions.size() * (sizeof(void *) + sizeof(int) + 2 * sizeof(void *)) + index->positions.bucket_count() * sizeof(void *);
+  for (size_t group = 0; group < groups.size(); group++)
+    size += groups[group]->MemoryUsage();
+  return size;
 }
 
 // --- cDuplicateRecordings ------------------------------------------------------
 
-cDuplicateRecordings::cDuplicateRecordings(void) : cList("duplicates") {}
+cDuplicateRecordings::cDuplicateRecordings(void) : current(new cDuplicateGeneration) {
+  generations = 0;
+}
+
+std::shared_ptr<const cDuplicateGeneration> cDuplicateRecordings::Get(void) {
+  cMutexLock MutexLock(&mutex);
+  return current;
+}
+
+bool cDuplicateRecordings::Publish(cDuplicateGeneration *Generation, const cDuplicateGeneration *Previous) {
+  if (!Generation->indexed)
+    Generation->Index();
+  std::shared_ptr<const cDuplicateGeneration> generation(Generation);
+  {
+    cMutexLock MutexLock(&mutex);
+    if (Previous && current.get() != Previous)
+      return false;
+    Generation->generation = ++generations;
+    current.swap(generation);
+  }
+  // the previous generation is released outside the lock, unless a reader still uses it
+  return true;
+}
 
 void cDuplicateRecordings::Remove(std::string fileName) {
-  cStateKey duplicateRecordingsStateKey;
-  Lock(duplicateRecordingsStateKey, true);
+  Remove(std::vector<std::string>(1, fileName));
+}
+
+void cDuplicateRecordings::Remove(const std::vector<std::string> &FileNames) {
   int rr = 0, rd = 0;
-  for (cDuplicateRecording *dr = First(); dr;) {
-    cDuplicateRecording *duplicateRecording = dr;
-    dr = Next(dr);
-    if (duplicateRecording->Duplicates()) {
-      for (cDuplicateRecording *d = duplicateRecording->Duplicates()->First(); d;) {
-        cDuplicateRecording *duplicate = d;
-        d = duplicateRecording->Duplicates()->Next(d);
-        if (duplicate->FileName() == fileName) {
-          duplicateRecording->Duplicates()->Del(duplicate);
-          rr++;
-        }
-      }
-      if (duplicateRecording->Duplicates()->Count() < 2) {
-        Del(duplicateRecording);
-        rd++;
-      } else if (duplicateRecording->HasDescription()) {
-        duplicateRecording->SetText(std::string(cString::sprintf(tr("%d duplicate recordings"), duplicateRecording->Duplicates()->Count())));
-      } else
-        duplicateRecording->SetText(std::string(cString::sprintf(tr("%d recordings without description"), duplicateRecording->Duplicates()->Count())));
-    } else {
-      Del(duplicateRecording);
-      rd++;
+  for (;;) {
+    std::shared_ptr<const cDuplicateGeneration> previous = Get();
+    std::vector<int> recordings;
+    for (std::vector<std::string>::const_iterator fileName = FileNames.begin(); fileName != FileNames.end(); ++fileName) {
+      int recording = previous->Find(fileName->c_str());
+      if (recording >= 0)
+        recordings.push_back(recording);
     }
+    if (recordings.empty())
+      break;
+    cDuplicateGeneration *generation = previous->Remove(recordings);
+    rr = recordings.size();
+    rd = previous->Groups() - generation->Groups();
+    if (Publish(generation, previous.get()))
+      break;
+    rr = rd = 0;
   }
-  duplicateRecordingsStateKey.Remove(rr > 0);
   dsyslog("duplicates: Removed %d recordings and %d duplicate recordings.", rr, rd);
 }
 
@@ -137,92 +266,751 @@ cDuplicateRecordings DuplicateRecordings;
 cDuplicateRecordingScannerThread::cDuplicateRecordingScannerThread() : cThread("duplicate recording scanner", true) {
   title = dc.title;
   hidden = dc.hidden;
+  normalization = dc.Normalization();
+  similarity = dc.similarity;
+  fingerprint = dc.fingerprint;
+  lengthTolerance = dc.lengthtolerance;
+  sizeTolerance = dc.sizetolerance;
+  triggerTime = 0;
+  indexed = true;
+  modified = false;
+  interruptions = 0;
+  lockWait = 0;
+  lockHold = 0;
 }
 
 cDuplicateRecordingScannerThread::~cDuplicateRecordingScannerThread(){
   Stop();
+  Reset();
 }
 
 void cDuplicateRecordingScannerThread::Stop(void) {
+  Cancel(-1);
+  triggerMutex.Lock();
+  triggerCondition.Broadcast();
+  triggerMutex.Unlock();
   Cancel(3);
 }
 
+void cDuplicateRecordingScannerThread::Trigger(void) {
+  cMutexLock MutexLock(&triggerMutex);
+  if (!triggerTime)
+    triggerTime = cTimeMs::Now();
+  triggerCondition.Broadcast();
+}
+
+bool cDuplicateRecordingScannerThread::WaitForTrigger(void) {
+  cMutexLock MutexLock(&triggerMutex);
+  while (Running()) {
+    if (triggerTime) {
+      int64_t delay = int64_t(triggerTime + dc.delay) - int64_t(cTimeMs::Now());
+      if (delay <= 0) {
+        triggerTime = 0;
+        return true;
+      }
+      triggerCondition.TimedWait(triggerMutex, delay);
+    } else
+      triggerCondition.Wait(triggerMutex);
+  }
+  return false;
+}
+
 void cDuplicateRecordingScannerThread::Action(void) {
+  title = dc.title;
+  hidden = dc.hidden;
+  normalization = dc.Normalization();
+  similarity = dc.similarity;
+  fingerprint = dc.fingerprint;
+  lengthTolerance = dc.lengthtolerance;
+  sizeTolerance = dc.sizetolerance;
+  Reset();
+  Load();
   while (Running()) {
-    if (title != dc.title || hidden != dc.hidden) {
+    if (title != dc.title || hidden != dc.hidden || normalization != dc.Normalization() || similarity != dc.similarity || fingerprint != dc.fingerprint
+        || lengthTolerance != dc.lengthtolerance || sizeTolerance != dc.sizetolerance) {
       recordingsStateKey.Reset();
+      bool reset = title != dc.title || normalization != dc.Normalization();
+      bool rematch = similarity != dc.similarity || lengthTolerance != dc.lengthtolerance || sizeTolerance != dc.sizetolerance;
       title = dc.title;
       hidden = dc.hidden;
+      normalization = dc.Normalization();
+      similarity = dc.similarity;
+      fingerprint = dc.fingerprint;
+      lengthTolerance = dc.lengthtolerance;
+      sizeTolerance = dc.sizetolerance;
+      if (reset)
+        Reset();
+      else if (rematch)
+        Rematch();
+    }
+    Scan();
+    if (WaitForTrigger())
+      recordingsStateKey.Reset();
+  }
+}
+
+int cDuplicateRecordingScannerThread::Insert(const char *FileName, const char *Text, const std::string &Title, const std::string &Description, const cInfoKey &Key) {
+  int id = table.Add(FileName, Text, Title, Description, Key);
+  if (id >= (int)matches.size())
+    matches.resize(id + 1);
+  if (table.HasDescription(id))
+    pending.insert(id);
+  modified = true;
+  return id;
+}
+
+void cDuplicateRecordingScannerThread::Unmatch(int Id) {
+  for (std::vector<int>::const_iterator m = matches[Id].begin(); m != matches[Id].end(); ++m) {
+    std::vector<int> &other = matches[*m];
+    std::vector<int>::iterator i = std::find(other.begin(), other.end(), Id);
+    if (i != other.end())
+      other.erase(i);
+  }
+  matches[Id].clear();
+}
+
+void cDuplicateRecordingScannerThread::Erase(int Id) {
+  pending.erase(Id);
+  if (indexed && table.HasDescription(Id))
+    index.Del(Id);
+  if (indexed)
+    similarityIndex.Del(Id);
+  Unmatch(Id);
+  table.Del(Id);
+  modified = true;
+}
+
+bool cDuplicateRecordingScannerThread::IsHidden(int Id) {
+  if (!table.Flag(Id, rfVisibility)) {
+    table.SetFlag(Id, rfHidden, VisibilityCache.Hidden(table.FileName(Id)));
+    table.SetFlag(Id, rfVisibility);
+  }
+  return table.Flag(Id, rfHidden);
+}
+
+void cDuplicateRecordingScannerThread::Reset(void) {
+  table.Clear();
+  matches.clear();
+  pending.clear();
+  index.Clear();
+  similarityIndex.Clear(similarity);
+  indexed = true;
+  modified = false;
+}
+
+void cDuplicateRecordingScannerThread::Rematch(void) {
+  // The normalized texts, measures and fingerprints don't depend on the
+  // comparison settings, only the matches and the indexes are built again.
+  for (std::vector<std::vector<int> >::iterator m = matches.begin(); m != matches.end(); ++m)
+    m->clear();
+  pending.clear();
+  for (int id = 0; id < table.Size(); id++) {
+    if (table.Used(id) && table.HasDescription(id))
+      pending.insert(id);
+  }
+  index.Clear();
+  similarityIndex.Clear(similarity);
+  indexed = false;
+  modified = true;
+}
+
+int cDuplicateRecordingScannerThread::CacheFlags(void) const {
+  // the cached titles, descriptions and matches depend on these settings
+  return title | (normalization << 1) | (similarity << 8) | (lengthTolerance << 15) | (sizeTolerance << 22);
+}
+
+void cDuplicateRecordingScannerThread::Load(void) {
+  // The cached recordings are validated against their info files in the
+  // first scan and the candidate index is only built when it is needed.
+  std::vector<cDuplicateCacheEntry> entries;
+  cDuplicateCache cache;
+  if (!cache.Load(entries, CacheFlags()))
+    return;
+  Reset();
+  for (std::vector<cDuplicateCacheEntry>::const_iterator entry = entries.begin(); entry != entries.end(); ++entry) {
+    int id = Insert(entry->fileName.c_str(), "", entry->title, entry->description, entry->key);
+    matches[id] = entry->matches;
+    if (entry->fingerprinted)
+      table.SetFingerprint(id, entry->fingerprint);
+    if (entry->measured)
+      table.SetMeasures(id, entry->length, entry->size);
+    if (!entry->pending)
+      pending.erase(id);
+  }
+  indexed = false;
+  modified = false;
+  dsyslog("duplicates: Loaded %d recordings from cache.", (int)entries.size());
+}
+
+void cDuplicateRecordingScannerThread::Save(void) {
+  if (!modified)
+    return;
+  std::vector<cDuplicateCacheEntry> entries;
+  std::vector<int> entryIndex(table.Size(), -1);
+  for (int id = 0; id < table.Size(); id++) {
+    if (table.Used(id)) {
+      entryIndex[id] = entries.size();
+      entries.push_back(cDuplicateCacheEntry());
+      cDuplicateCacheEntry &entry = entries.back();
+      entry.fileName = table.FileName(id);
+      entry.key = table.Key(id);
+      entry.title.assign(table.Title(id), table.TitleSize(id));
+      entry.description.assign(table.Description(id), table.DescriptionSize(id));
+      entry.pending = pending.count(id) > 0;
+      entry.fingerprinted = table.Flag(id, rfFingerprint);
+      entry.fingerprint = table.Fingerprint(id);
+      entry.measured = table.Flag(id, rfMeasured);
+      entry.length = table.Length(id);
+      entry.size = table.FileSize(id);
     }
-    if (cRecordings::GetRecordingsRead(recordingsStateKey)) {
-      recordingsStateKey.Remove();
-      Scan();
+  }
+  for (int id = 0; id < table.Size(); id++) {
+    if (table.Used(id)) {
+      std::vector<int> &entryMatches = entries[entryIndex[id]].matches;
+      for (std::vector<int>::const_iterator m = matches[id].begin(); m != matches[id].end(); ++m)
+        entryMatches.push_back(entryIndex[*m]);
     }
-    if (Running())
-      cCondWait::SleepMs(500);
   }
+  cDuplicateCache cache;
+  if (cache.Save(entries, CacheFlags()))
+    modified = false;
+}
+
+// --- cDuplicateRecordingComparison ---------------------------------------------
+
+// The comparison of the pending recordings, shared by the scanner and its
+// worker threads. Every worker takes the next pending recording and stores
+// its matches in its own slot, so the result doesn't depend on the number
+// of threads.
+
+class cDuplicateRecordingComparison {
+private:
+  cMutex mutex;
+  size_t next;
+  bool aborted;
+  const cRecordingTable &table;
+  const cContainmentIndex &index;
+  const cSimilarityIndex &similarityIndex;
+  bool title;
+  int similarity;
+  int lengthTolerance;
+  int sizeTolerance;
+public:
+  std::vector<int> work;
+  std::vector<std::vector<int> > found;
+  std::vector<int> considered;
+  std::vector<int> compared;
+  std::vector<char> done;
+  cDuplicateRecordingComparison(const cRecordingTable &Table, const cContainmentIndex &Index, const cSimilarityIndex &SimilarityIndex, bool Title, int Similarity, int LengthTolerance, int SizeTolerance, const std::set<int> &Pending);
+  int Next(void);
+  void Abort(void);
+  void Compare(int Work);
+};
+
+cDuplicateRecordingComparison::cDuplicateRecordingComparison(const cRecordingTable &Table, const cContainmentIndex &Index, const cSimilarityIndex &SimilarityIndex, bool Title, int Similarity, int LengthTolerance, int SizeTolerance, const std::set<int> &Pending) :
+  next(0),
+  aborted(false),
+  table(Table),
+  index(Index),
+  similarityIndex(SimilarityIndex),
+  title(Title),
+  similarity(Similarity),
+  lengthTolerance(LengthTolerance),
+  sizeTolerance(SizeTolerance),
+  work(Pending.begin(), Pending.end()),
+  found(work.size()),
+  considered(work.size(), 0),
+  compared(work.size(), 0),
+  done(work.size(), false) {}
+
+int cDuplicateRecordingComparison::Next(void) {
+  cMutexLock MutexLock(&mutex);
+  if (aborted || next >= work.size())
+    return -1;
+  return next++;
+}
+
+void cDuplicateRecordingComparison::Abort(void) {
+  cMutexLock MutexLock(&mutex);
+  aborted = true;
+}
+
+void cDuplicateRecordingComparison::Compare(int Work) {
+  if (cIoThrottle::Engaged())
+    cCondWait::SleepMs(100);
+  int id = work[Work];
+  std::vector<int> candidates;
+  index.Candidates(id, table.Description(id), table.DescriptionSize(id), candidates);
+  if (similarity) {
+    similarityIndex.Candidates(id, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  }
+  for (std::vector<int>::const_iterator c = candidates.begin(); c != candidates.end(); ++c) {
+    if (*c > id && std::binary_search(work.begin(), work.end(), *c))
+      continue; // compared by the pending recording with the higher id
+    considered[Work]++;
+    if (!table.SimilarMeasures(id, *c, lengthTolerance, sizeTolerance))
+      continue;
+    compared[Work]++;
+    if (table.Matches(id, *c, title) || similarity && similarityIndex.Similarity(id, *c) >= similarity && (!title || table.TitlesMatch(id, *c)))
+      found[Work].push_back(*c);
+  }
+  done[Work] = true;
+}
+
+// --- cDuplicateRecordingCompareThread ------------------------------------------
+
+class cDuplicateRecordingCompareThread : public cThread {
+private:
+  cDuplicateRecordingComparison *comparison;
+protected:
+  virtual void Action(void);
+public:
+  cDuplicateRecordingCompareThread(cDuplicateRecordingComparison *Comparison);
+  ~cDuplicateRecordingCompareThread();
+};
+
+cDuplicateRecordingCompareThread::cDuplicateRecordingCompareThread(cDuplicateRecordingComparison *Comparison) : cThread("duplicate recording comparison", true) {
+  comparison = Comparison;
+}
+
+cDuplicateRecordingCompareThread::~cDuplicateRecordingCompareThread() {
+  Cancel(3);
+}
+
+void cDuplicateRecordingCompareThread::Action(void) {
+  for (int work; Running() && (work = comparison->Next()) >= 0;)
+    comparison->Compare(work);
+}
+
+// --- cDuplicateRecordingScannerThread ------------------------------------------
+
+void cDuplicateRecordingScannerThread::Merge(cDuplicateRecordingComparison &Comparison) {
+  {
+    cMutexLock MutexLock(&statisticsMutex);
+    for (size_t w = 0; w < Comparison.work.size(); w++) {
+      statistics.comparisons += Comparison.compared[w];
+      statistics.candidates += Comparison.considered[w];
+    }
+  }
+  for (size_t w = 0; w < Comparison.work.size(); w++) {
+    if (!Comparison.done[w])
+      continue;
+    int id = Comparison.work[w];
+    for (std::vector<int>::const_iterator m = Comparison.found[w].begin(); m != Comparison.found[w].end(); ++m) {
+      if (std::find(matches[id].begin(), matches[id].end(), *m) == matches[id].end()) {
+        matches[id].push_back(*m);
+        matches[*m].push_back(id);
+      }
+    }
+    pending.erase(id);
+    modified = true;
+  }
+}
+
+bool cDuplicateRecordingScannerThread::Compare(void) {
+  // Compares the pending recordings against all others and remembers the
+  // matches. Returns false if the comparison was interrupted, the rest of
+  // the pending recordings are compared in the next scan. The matches found
+  // so far are kept, unless the recordings involved change in the meantime.
+  if (pending.empty())
+    return true;
+  cDuplicateRecordingComparison comparison(table, index, similarityIndex, title, similarity, lengthTolerance, sizeTolerance, pending);
+  int threads = std::min(std::max(dc.threads, 1), MAXCOMPARETHREADS) - 1;
+  if (threads > (int)comparison.work.size() / 64)
+    threads = comparison.work.size() / 64;
+  std::vector<cDuplicateRecordingCompareThread *> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.push_back(new cDuplicateRecordingCompareThread(&comparison));
+    workers.back()->Start();
+  }
+  bool interrupted = false;
+  for (int work; (work = comparison.Next()) >= 0;) {
+    if (!Running() || Interrupted()) {
+      comparison.Abort();
+      interrupted = true;
+      break;
+    }
+    comparison.Compare(work);
+  }
+  for (std::vector<cDuplicateRecordingCompareThread *>::iterator worker = workers.begin(); worker != workers.end(); ++worker) {
+    while ((*worker)->Active()) {
+      if (!interrupted && (!Running() || Interrupted())) {
+        comparison.Abort();
+        interrupted = true;
+      }
+      cCondWait::SleepMs(10);
+    }
+    delete *worker;
+  }
+  Merge(comparison);
+  if (interrupted)
+    dsyslog("duplicates: Comparison interrupted with %d recordings left to compare.", (int)pending.size());
+  return !interrupted;
+}
+
+static std::string SortName(const char *FileName) {
+  // Only approximates the order of VDR's recordings menu. VDR also strips
+  // episode names when folders are sorted first or recordings by time, which
+  // it keeps private, and comparing its own sort names would write VDR's
+  // sort buffers under a read lock. Groups and their recordings may
+  // therefore be in a slightly different order than in VDR's menu.
+  size_t l = strlen(cVideoDirectory::Name());
+  if (strncmp(FileName, cVideoDirectory::Name(), l) == 0)
+    FileName += l;
+  std::string name(FileName);
+  std::replace(name.begin(), name.end(), '/', '0'); // some locales ignore '/' when sorting
+  std::string sortName(strxfrm(NULL, name.c_str(), 0) + 1, 0);
+  sortName.resize(strxfrm(&sortName[0], name.c_str(), sortName.size()));
+  return sortName;
+}
+
+static const char *Safe(const char *s) {
+  return s ? s : "";
+}
+
+bool cDuplicateRecordingScannerThread::Snapshot(void) {
+  cTimeMs lockTime;
+  const cRecordings *Recordings = cRecordings::GetRecordingsRead(recordingsStateKey);
+  if (!Recordings)
+    return false;
+  lockWait = lockTime.Elapsed();
+  lockTime.Set();
+  snapshot.resize(Recordings->Count());
+  std::vector<cDuplicateRecordingSnapshot>::iterator s = snapshot.begin();
+  excludedMutex.Lock();
+  for (const cRecording *recording = Recordings->First(); recording; recording = Recordings->Next(recording)) {
+    if (!excluded.empty() && excluded.count(recording->FileName()))
+      continue;
+    s->fileName = recording->FileName();
+    s->infoFileName = Safe(recording->Info()->FileName());
+    s->text = recording->Title('\t', true);
+    s->title = Safe(recording->Info()->Title());
+    s->shortText = Safe(recording->Info()->ShortText());
+    s->description = Safe(recording->Info()->Description());
+    s->framesPerSecond = recording->FramesPerSecond();
+    s->inUse = recording->IsInUse() & (ruTimer | ruDst);
+    ++s;
+  }
+  excludedMutex.Unlock();
+  snapshot.erase(s, snapshot.end());
+  recordingsStateKey.Remove(false);
+  lockHold = lockTime.Elapsed();
+  dsyslog("duplicates: Read lock held for %d ms to take over %d recordings.", lockHold, (int)snapshot.size());
+  return true;
+}
+
+static uint64_t SourceHash(const cDuplicateRecordingSnapshot &Recording) {
+  // FNV-1a over the info texts a recording is normalized from, never 0
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  const std::string *texts[] = { &Recording.title, &Recording.shortText, &Recording.description };
+  for (int i = 0; i < 3; i++) {
+    for (std::string::const_iterator c = texts[i]->begin(); c != texts[i]->end(); ++c)
+      hash = (hash ^ (unsigned char)*c) * 0x100000001B3ULL;
+    hash = (hash ^ 0xFF) * 0x100000001B3ULL; // separator, not part of UTF-8 text
+  }
+  return hash ? hash : 1;
+}
+
+static bool CompareSortNames(const cDuplicateRecordingSnapshot *a, const cDuplicateRecordingSnapshot *b) {
+  return strcasecmp(a->sortName.c_str(), b->sortName.c_str()) < 0;
 }
 
 void cDuplicateRecordingScannerThread::Scan(void) {
+  int phases[spCount];
+  cTimeMs phaseTime;
+  if (!Snapshot())
+    return;
+  phases[spSnapshot] = phaseTime.Elapsed();
   dsyslog("duplicates: Scanning of duplicate recordings started.");
+  if (interruptions >= MAXINTERRUPTIONS)
+    dsyslog("duplicates: Scan was interrupted %d times, ignoring further changes until it is finished.", interruptions);
   struct timeval startTime, stopTime;
   gettimeofday(&startTime, NULL);
+  bool full = table.Count() == 0;
+  std::vector<const cDuplicateRecordingSnapshot *> recordings(snapshot.size());
+  for (size_t i = 0; i < snapshot.size(); i++) {
+    snapshot[i].sortName = SortName(snapshot[i].fileName.c_str());
+    recordings[i] = &snapshot[i];
+  }
+  std::stable_sort(recordings.begin(), recordings.end(), CompareSortNames);
+  std::vector<int> order;
+  std::vector<int> unfingerprinted;
+  std::vector<bool> seen(table.Size(), false);
+  std::set<int> added;
+  int changed = 0;
+  for (std::vector<const cDuplicateRecordingSnapshot *>::const_iterator r = recordings.begin(); r != recordings.end(); ++r) {
+    const cDuplicateRecordingSnapshot *recording = *r;
+    int id = table.Find(recording->fileName.c_str());
+    uint64_t source = SourceHash(*recording);
+    bool unchanged = false;
+    if (id >= 0) {
+      if (table.Source(id) == source)
+        unchanged = true;
+      else {
+        // The info texts have changed, or the recording was taken over from
+        // the cache and is checked against its info file once.
+        cInfoKey key;
+        key.Read(recording->infoFileName.c_str());
+        unchanged = !table.Source(id) && key == table.Key(id);
+        if (!unchanged) {
+          table.SetKey(id, key);
+          modified = true;
+        }
+      }
+      if (unchanged)
+        table.SetText(id, recording->text.c_str());
+    }
+    if (!unchanged) {
+      titleBuffer.clear();
+      if (title)
+        titleBuffer = normalizer.Normalize(normalization, recording->title.c_str());
+      const std::string &description = normalizer.Normalize(nmSeparators | normalization, recording->shortText.c_str(), recording->description.c_str());
+      if (id >= 0 && table.SameContent(id, titleBuffer, description)) {
+        // keep the matches, but take over the current text
+        table.SetText(id, recording->text.c_str());
+      } else {
+        cInfoKey key;
+        if (id >= 0) {
+          key = table.Key(id);
+          Erase(id);
+          changed++;
+        } else
+          key.Read(recording->infoFileName.c_str());
+        id = Insert(recording->fileName.c_str(), recording->text.c_str(), titleBuffer, description, key);
+        added.insert(id);
+      }
+    }
+    table.SetSource(id, source);
+    if (id >= (int)seen.size())
+      seen.resize(id + 1, false);
+    seen[id] = true;
+    order.push_back(id);
+    if (fingerprint && !table.HasDescription(id) && !table.Flag(id, rfFingerprint) && !recording->inUse)
+      unfingerprinted.push_back(id);
+    if ((lengthTolerance || sizeTolerance) && !table.Flag(id, rfMeasured) && !recording->inUse) {
+      // measured once, when the recording is finished
+      int length, size;
+      Measure(recording->fileName.c_str(), recording->framesPerSecond, length, size);
+      table.SetMeasures(id, length, size);
+      if (table.HasDescription(id) && !added.count(id)) {
+        // compared while it was still being recorded
+        Unmatch(id);
+        pending.insert(id);
+      }
+      modified = true;
+    }
+  }
+  snapshot.clear();
+  std::vector<const char *> fileNames;
+  fileNames.reserve(order.size());
+  for (std::vector<int>::const_iterator id = order.begin(); id != order.end(); ++id)
+    fileNames.push_back(table.FileName(*id));
+  VisibilityCache.Update(fileNames);
+  int removed = 0;
+  for (int id = 0; id < table.Size(); id++) {
+    if (table.Used(id) && !seen[id]) {
+      Erase(id);
+      removed++;
+    }
+  }
+  if (indexed && index.NeedsRebuild()) {
+    // gets rid of the deleted descriptions, built again like after loading the cache
+    index.Clear();
+    similarityIndex.Clear(similarity);
+    indexed = false;
+  }
+  if (!indexed && !pending.empty()) {
+    for (int id = 0; id < table.Size(); id++) {
+      if (table.Used(id) && table.HasDescription(id))
+        index.Count(id, table.Description(id), table.DescriptionSize(id));
+    }
+    for (int id = 0; id < table.Size(); id++) {
+      if (table.Used(id) && table.HasDescription(id))
+        index.Add(id, table.Description(id), table.DescriptionSize(id));
+    }
+    for (int id = 0; id < table.Size(); id++) {
+      if (similarity && table.Used(id) && table.HasDescription(id))
+        similarityIndex.Add(id, table.Description(id), table.DescriptionSize(id));
+    }
+    indexed = true;
+  } else if (indexed) {
+    for (std::set<int>::const_iterator id = added.begin(); id != added.end(); ++id) {
+      if (table.HasDescription(*id))
+        index.Count(*id, table.Description(*id), table.DescriptionSize(*id));
+    }
+    for (std::set<int>::const_iterator id = added.begin(); id != added.end(); ++id) {
+      if (table.HasDescription(*id))
+        index.Add(*id, table.Description(*id), table.DescriptionSize(*id));
+    }
+    for (std::set<int>::const_iterator id = added.begin(); id != added.end(); ++id) {
+      if (similarity && table.HasDescription(*id))
+        similarityIndex.Add(*id, table.Description(*id), table.DescriptionSize(*id));
+    }
+  }
+  dsyslog("duplicates: %s scan with %d added, %d changed and %d removed recordings.", full ? "Full" : "Incremental", (int)added.size() - changed, changed, removed);
+  phases[spNormalize] = phaseTime.Elapsed() - phases[spSnapshot];
+  if (!Compare()) {
+    Aborted();
+    return;
+  }
+  phases[spCompare] = phaseTime.Elapsed() - phases[spSnapshot] - phases[spNormalize];
+  if (!PublishDuplicates(order)) {
+    Aborted();
+    return;
+  }
+  if (interruptions >= MAXINTERRUPTIONS)
+    RecordingsStateChanged(); // catches up with the changes ignored meanwhile
+  interruptions = 0;
+  Save();
+  phases[spPublish] = phaseTime.Elapsed() - phases[spSnapshot] - phases[spNormalize] - phases[spCompare];
+  if (!unfingerprinted.empty()) {
+    // Reading the fingerprints may take minutes, so the duplicates found by
+    // their descriptions are published before, and the copies afterwards.
+    cTimeMs fingerprintTime;
+    bool fingerprinted = FingerprintRecordings(unfingerprinted);
+    phases[spCompare] += fingerprintTime.Elapsed();
+    cTimeMs publishTime;
+    if (fingerprinted)
+      PublishDuplicates(order);
+    Save(); // keeps the fingerprints taken before an interruption
+    phases[spPublish] += publishTime.Elapsed();
+  }
+  std::shared_ptr<const cDuplicateGeneration> published = DuplicateRecordings.Get();
+  size_t resultMemory = published->MemoryUsage();
+  int groups = published->Groups();
+  published.reset();
+  {
+    cMutexLock MutexLock(&statisticsMutex);
+    statistics.scans++;
+    for (int p = 0; p < spCount; p++) {
+      statistics.last[p] = phases[p];
+      statistics.total[p] += phases[p];
+    }
+    statistics.lockWait = lockWait;
+    statistics.lockHold = lockHold;
+    statistics.recordings = table.Count();
+    statistics.groups = groups;
+    statistics.resultMemory = resultMemory;
+    statistics.tableMemory = table.MemoryUsage();
+  }
+  gettimeofday(&stopTime, NULL);
+  double seconds = (((long long)stopTime.tv_sec * 1000000 + stopTime.tv_usec) - ((long long)startTime.tv_sec * 1000000 + startTime.tv_usec)) / 1000000.0;
+  dsyslog("duplicates: Scanning of duplicate recordings took %.2f seconds.", seconds);
+}
+
+bool cDuplicateRecordingScannerThread::PublishDuplicates(const std::vector<int> &Order) {
+  std::vector<int> position(table.Size(), -1);
+  for (size_t p = 0; p < Order.size(); p++)
+    position[Order[p]] = p;
+  table.ClearFlags(rfChecked | rfVisibility);
   cDuplicateRecording *descriptionless = new cDuplicateRecording();
-  cList<cDuplicateRecording> recordings;
-  cRecordings *Recordings = cRecordings::GetRecordingsWrite(recordingsStateKey); // write access is necessary for sorting!
-  Recordings->Sort();
-  for (const cRecording *recording = Recordings->First(); recording; recording = Recordings->Next(recording)) {
-    cDuplicateRecording *Item = new cDuplicateRecording(recording);
-    if (Item->HasDescription())
-      recordings.Add(Item);
-    else if (dc.hidden || Item->Visibility().Read() != HIDDEN)
-      descriptionless->Duplicates()->Add(Item);
-  }
-  recordingsStateKey.Remove(false); // sorting doesn't count as a real modification
-  cList<cDuplicateRecording> duplicates;
-  for (cDuplicateRecording *recording = recordings.First(); recording; recording = recordings.Next(recording)) {
-    if (!Running() || RecordingsStateChanged()) {
-      delete descriptionless;
-      return;
-    }
-    if (cIoThrottle::Engaged())
-      cCondWait::SleepMs(100);
-    if (!recording->Checked()) {
-      recording->SetChecked();
-      cDuplicateRecording *duplicate = new cDuplicateRecording();
-      duplicate->Duplicates()->Add(new cDuplicateRecording(*recording));
-      for (cDuplicateRecording *compare = recordings.First(); compare; compare = recordings.Next(compare)) {
-        if (!compare->Checked()) {
-          if (recording->IsDuplicate(compare)) {
-            duplicate->Duplicates()->Add(new cDuplicateRecording(*compare));
-            compare->SetChecked();
+  cDuplicateGeneration *duplicates = new cDuplicateGeneration;
+  std::unordered_map<uint64_t, int> copies;
+  if (fingerprint) {
+    for (std::vector<int>::const_iterator id = Order.begin(); id != Order.end(); ++id) {
+      if (!table.HasDescription(*id) && table.Fingerprint(*id) && (dc.hidden || !IsHidden(*id)))
+        copies[table.Fingerprint(*id)]++;
+    }
+  }
+  std::unordered_map<uint64_t, cDuplicateRecording *> contents;
+  std::vector<int> candidates;
+  for (std::vector<int>::const_iterator id = Order.begin(); id != Order.end(); ++id) {
+    if (!table.HasDescription(*id)) {
+      if (dc.hidden || !IsHidden(*id)) {
+        if (fingerprint && table.Fingerprint(*id) && copies[table.Fingerprint(*id)] > 1) {
+          // copies of the same recording are duplicates, even without description
+          cDuplicateRecording *&content = contents[table.Fingerprint(*id)];
+          if (!content) {
+            content = new cDuplicateRecording(true);
+            duplicates->Add(content);
           }
+          content->Duplicates()->Add(new cDuplicateRecording(table, *id));
+        } else
+          descriptionless->Duplicates()->Add(new cDuplicateRecording(table, *id));
+      }
+      continue;
+    }
+    if (!table.Flag(*id, rfChecked)) {
+      table.SetFlag(*id, rfChecked);
+      candidates.clear();
+      if (dc.hidden || !IsHidden(*id)) {
+        for (std::vector<int>::const_iterator m = matches[*id].begin(); m != matches[*id].end(); ++m) {
+          if (!table.Flag(*m, rfChecked) && (dc.hidden || !IsHidden(*m)))
+            candidates.push_back(position[*m]);
         }
       }
-      if (duplicate->Duplicates()->Count() > 1) {
-        duplicate->SetText(std::string(cString::sprintf(tr("%d duplicate recordings"), duplicate->Duplicates()->Count())));
-        duplicates.Add(duplicate);
-      } else
-        delete duplicate;
+      if (candidates.empty())
+        continue;
+      std::sort(candidates.begin(), candidates.end());
+      cDuplicateRecording *duplicate = new cDuplicateRecording();
+      duplicate->Duplicates()->Add(new cDuplicateRecording(table, *id));
+      for (std::vector<int>::const_iterator p = candidates.begin(); p != candidates.end(); ++p) {
+        duplicate->Duplicates()->Add(new cDuplicateRecording(table, Order[*p]));
+        table.SetFlag(Order[*p], rfChecked);
+      }
+      duplicate->SetText(std::string(cString::sprintf(tr("%d duplicate recordings"), duplicate->Duplicates()->Count())));
+      duplicates->Add(duplicate);
     }
   }
+  for (std::unordered_map<uint64_t, cDuplicateRecording *>::const_iterator content = contents.begin(); content != contents.end(); ++content)
+    content->second->SetText(std::string(cString::sprintf(tr("%d duplicate recordings"), content->second->Duplicates()->Count())));
   if (descriptionless->Duplicates()->Count() > 0) {
     descriptionless->SetText(std::string(cString::sprintf(tr("%d recordings without description"), descriptionless->Duplicates()->Count())));
-    duplicates.Add(descriptionless);
+    duplicates->Add(descriptionless);
   } else
     delete descriptionless;
-  if (RecordingsStateChanged())
-    return;
-  cStateKey duplicateRecordingsStateKey;
-  DuplicateRecordings.Lock(duplicateRecordingsStateKey, true);
-  DuplicateRecordings.Clear();
-  for (cDuplicateRecording *duplicate = duplicates.First(); duplicate; duplicate = duplicates.Next(duplicate)) {
-    DuplicateRecordings.Add(new cDuplicateRecording(*duplicate));
+  if (Interrupted()) {
+    delete duplicates;
+    return false;
   }
-  duplicateRecordingsStateKey.Remove();
-  gettimeofday(&stopTime, NULL);
-  double seconds = (((long long)stopTime.tv_sec * 1000000 + stopTime.tv_usec) - ((long long)startTime.tv_sec * 1000000 + startTime.tv_usec)) / 1000000.0;
-  dsyslog("duplicates: Scanning of duplicate recordings took %.2f seconds.", seconds);
+  DuplicateRecordings.Publish(duplicates);
+  return true;
+}
+
+bool cDuplicateRecordingScannerThread::FingerprintRecordings(const std::vector<int> &Ids) {
+  // Reads only a few packets of every recording, but waits while the I/O is
+  // throttled and pauses between two recordings, so that the fingerprints
+  // don't compete with recordings and replays for the video disk.
+  for (size_t i = 0; i < Ids.size(); i++) {
+    for (;;) {
+      if (!Running() || Interrupted()) {
+        dsyslog("duplicates: Fingerprinting interrupted with %d recordings left.", int(Ids.size() - i));
+        return false;
+      }
+      if (!cIoThrottle::Engaged())
+        break;
+      cCondWait::SleepMs(FINGERPRINTINTERVAL);
+    }
+    uint64_t content;
+    table.SetFingerprint(Ids[i], Fingerprint(table.FileName(Ids[i]), content) ? content : 0);
+    modified = true;
+    cCondWait::SleepMs(FINGERPRINTINTERVAL);
+  }
+  if (!Ids.empty())
+    dsyslog("duplicates: Fingerprinted %d recordings.", (int)Ids.size());
+  return true;
+}
+
+void cDuplicateRecordingScannerThread::Aborted(void) {
+  cMutexLock MutexLock(&statisticsMutex);
+  statistics.aborted++;
+}
+
+void cDuplicateRecordingScannerThread::Exclude(const std::vector<std::string> &FileNames, bool Excluded) {
+  cMutexLock MutexLock(&excludedMutex);
+  for (std::vector<std::string>::const_iterator fileName = FileNames.begin(); fileName != FileNames.end(); ++fileName) {
+    if (Excluded)
+      excluded.insert(*fileName);
+    else
+      excluded.erase(*fileName);
+  }
+}
+
+cDuplicateScanStatistics cDuplicateRecordingScannerThread::Statistics(void) {
+  cMutexLock MutexLock(&statisticsMutex);
+  return statistics;
 }
 
 bool cDuplicateRecordingScannerThread::RecordingsStateChanged(void) {
@@ -230,11 +1018,21 @@ bool cDuplicateRecordingScannerThread::RecordingsStateChanged(void) {
     recordingsStateKey.Reset();
     recordingsStateKey.Remove();
     dsyslog("duplicates: Recordings state changed while scanning.");
-    cCondWait::SleepMs(500);
+    Trigger();
     return true;
   }
   return false;
 }
 
+bool cDuplicateRecordingScannerThread::Interrupted(void) {
+  // A scan is given up when the recordings change, but after MAXINTERRUPTIONS
+  // scans in a row it is finished regardless, so that a steady stream of
+  // changes can't keep the list from ever being updated.
+  if (interruptions >= MAXINTERRUPTIONS || !RecordingsStateChanged())
+    return false;
+  interruptions++;
+  return true;
+}
+
 cDuplicateRecordingScannerThread DuplicateRecordingScanner;
 
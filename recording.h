@@ -9,62 +9,239 @@
 #ifndef _DUPLICATES_RECORDING_H
 #define _DUPLICATES_RECORDING_H
 
+#include "cache.h"
+#include "index.h"
+#include "normalize.h"
+#include "services.h"
+#include "table.h"
 #include "visibility.h"
 #include <vdr/recording.h>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // --- cDuplicateRecording -------------------------------------------------------
 
 class cDuplicateRecording : public cListObject {
 private:
-  bool checked;
+  bool hasDescription;
   cVisibility visibility;
   std::string fileName;
   std::string text;
-  std::string title;
-  std::string description;
+  int fileSize;
   cList<cDuplicateRecording> *duplicates;
 public:
-  cDuplicateRecording(void);
-  cDuplicateRecording(const cRecording *Recording);
+  cDuplicateRecording(bool HasDescription = false);
+  cDuplicateRecording(const cRecordingTable &Table, int Id);
   cDuplicateRecording(const cDuplicateRecording &DuplicateRecording);
   ~cDuplicateRecording();
   bool HasDescription(void) const;
-  bool IsDuplicate(cDuplicateRecording *DuplicateRecording);
-  void SetChecked(bool chkd = true) { checked = chkd; }
-  bool Checked() { return checked; }
-  cVisibility Visibility() { return visibility; }
-  std::string FileName(void) { return fileName; }
+  cVisibility Visibility() const { return visibility; }
+  const std::string &FileName(void) const { return fileName; }
   void SetText(std::string t) { text = t; }
-  std::string Text(void) { return text; }
+  const std::string &Text(void) const { return text; }
+  int FileSizeMB(void) const { return fileSize; }
+      ///< Returns the size measured by the scanner, or -1 if it hasn't been.
   cList<cDuplicateRecording> *Duplicates(void) { return duplicates; }
+  const cList<cDuplicateRecording> *Duplicates(void) const { return duplicates; }
+  size_t MemoryUsage(void) const;
+};
+
+// --- cDuplicateGeneration ------------------------------------------------------
+
+// The complete result of one scan. A generation is never modified once it
+// has been published, so a reader may keep it as long as it holds a reference.
+// Groups and the file name index are shared with the generations derived
+// from it by Remove().
+// It is also the view handed out to other plugins.
+
+struct cFileNameHash {
+  size_t operator()(const char *FileName) const;
+};
+
+struct cFileNameEqual {
+  bool operator()(const char *a, const char *b) const { return strcmp(a, b) == 0; }
+};
+
+struct cDuplicateIndex {
+  std::vector<std::shared_ptr<const cDuplicateRecording> > groups; // own the file names
+  std::unordered_map<const char *, int, cFileNameHash, cFileNameEqual> positions;
+};
+
+class cDuplicateGeneration : public cDuplicatesView {
+  friend class cDuplicateRecordings;
+private:
+  int generation;
+  bool indexed;
+  std::vector<std::shared_ptr<const cDuplicateRecording> > groups;
+  std::vector<const cDuplicateRecording *> recordings;
+  std::vector<int> recordingGroups;
+  std::vector<int> firstRecordings;
+  std::shared_ptr<const cDuplicateIndex> index; // shared with the generations derived by Remove()
+  std::vector<int> removed; // sorted positions in index of the recordings removed since
+  void Index(void);
+  cDuplicateGeneration *Remove(std::vector<int> Recordings) const;
+      ///< Returns a new generation without the given Recordings. Their groups are
+      ///< copied and retitled, or dropped if less than two recordings are left.
+public:
+  cDuplicateGeneration(void) { generation = 0; indexed = false; }
+  void Add(cDuplicateRecording *Group);
+      ///< Adds Group at the end and takes ownership of it.
+  virtual int Generation(void) const { return generation; }
+  virtual int Groups(void) const { return groups.size(); }
+  virtual const char *GroupText(int Group) const { return groups[Group]->Text().c_str(); }
+  virtual bool IsDuplicates(int Group) const { return groups[Group]->HasDescription(); }
+  virtual int Recordings(void) const { return recordings.size(); }
+  virtual const char *FileName(int Recording) const { return recordings[Recording]->FileName().c_str(); }
+  virtual int Group(int Recording) const { return recordingGroups[Recording]; }
+  virtual int Find(const char *FileName) const;
+  const cDuplicateRecording *GroupRecording(int Group) const { return groups[Group].get(); }
+  const cDuplicateRecording *Recording(int Recording) const { return recordings[Recording]; }
+  int FirstRecording(int Group) const { return firstRecordings[Group]; }
+      ///< Returns the index of the first recording of the given Group.
+  size_t MemoryUsage(void) const;
+      ///< Returns the approximate number of bytes used by this generation.
 };
 
 // --- cDuplicateRecordings ------------------------------------------------------
 
-class cDuplicateRecordings : public cList<cDuplicateRecording> {
+class cDuplicateRecordings {
+private:
+  cMutex mutex;
+  int generations;
+  std::shared_ptr<const cDuplicateGeneration> current;
 public:
   cDuplicateRecordings(void);
+  std::shared_ptr<const cDuplicateGeneration> Get(void);
+      ///< Returns the current generation.
+  bool Publish(cDuplicateGeneration *Generation, const cDuplicateGeneration *Previous = NULL);
+      ///< Makes Generation the current one and takes ownership of it. If Previous
+      ///< is given, Generation is only published if Previous is still current.
   void Remove(std::string fileName);
+  void Remove(const std::vector<std::string> &FileNames);
+      ///< Removes all FileNames from the current generation at once.
 };
 
 extern cDuplicateRecordings DuplicateRecordings;
 
+// --- cDuplicateRecordingSnapshot -----------------------------------------------
+
+// What the scanner takes over from a recording while it holds the read lock.
+
+struct cDuplicateRecordingSnapshot {
+  std::string sortName;
+  std::string fileName;
+  std::string infoFileName;
+  std::string text;
+  std::string title;
+  std::string shortText;
+  std::string description;
+  double framesPerSecond;
+  bool inUse;
+};
+
+// --- cDuplicateScanStatistics --------------------------------------------------
+
+enum eScanPhase {
+  spSnapshot,  // taking over the recordings under the read lock
+  spNormalize, // normalizing, diffing and indexing the recordings
+  spCompare,   // comparing the pending recordings and fingerprinting
+  spPublish,   // grouping, publishing and saving the cache
+  spCount
+  };
+
+struct cDuplicateScanStatistics {
+  int scans;               // finished scans
+  int aborted;             // scans given up because the recordings changed
+  int last[spCount];       // ms, of the last finished scan
+  int64_t total[spCount];  // ms, of all finished scans
+  uint64_t comparisons;    // pairs of recordings compared
+  uint64_t candidates;     // candidate pairs found by the indexes
+  int lockWait;            // ms, waited for the read lock in the last scan
+  int lockHold;            // ms, the read lock was held in the last scan
+  int recordings;
+  int groups;
+  size_t resultMemory;     // bytes, of the current generation
+  size_t tableMemory;      // bytes, of the scanner's recording table
+  cDuplicateScanStatistics(void) { memset(this, 0, sizeof(*this)); }
+};
+
 // --- cDuplicateRecordingScannerThread ------------------------------------------
 
+#define MAXCOMPARETHREADS 16
+#define MAXSCANDELAY      60000 // ms
+#define MAXINTERRUPTIONS  3
+#define MAXSIMILARITY     100 // %
+#define MAXLENGTHTOLERANCE 120 // min
+#define MAXSIZETOLERANCE  100 // %
+
+class cDuplicateRecordingComparison;
+
 class cDuplicateRecordingScannerThread : public cThread {
 private:
+  cMutex triggerMutex;
+  cCondVar triggerCondition;
+  uint64_t triggerTime;
   cStateKey recordingsStateKey;
   int title;
   int hidden;
+  int normalization;
+  int similarity;
+  int fingerprint;
+  int lengthTolerance;
+  int sizeTolerance;
+  cNormalizer normalizer;
+  std::string titleBuffer;
+  cRecordingTable table;
+  std::vector<std::vector<int> > matches;
+  std::set<int> pending;
+  cContainmentIndex index;
+  cSimilarityIndex similarityIndex;
+  bool indexed;
+  bool modified;
+  int interruptions;
+  cMutex statisticsMutex;
+  cDuplicateScanStatistics statistics;
+  int lockWait;
+  int lockHold;
+  std::vector<cDuplicateRecordingSnapshot> snapshot;
+  cMutex excludedMutex;
+  std::set<std::string> excluded;
+  bool Snapshot(void);
+  int Insert(const char *FileName, const char *Text, const std::string &Title, const std::string &Description, const cInfoKey &Key);
+  void Unmatch(int Id);
+  void Erase(int Id);
+  bool IsHidden(int Id);
+  void Reset(void);
+  void Rematch(void);
+  int CacheFlags(void) const;
+  void Load(void);
+  void Save(void);
+  void Merge(cDuplicateRecordingComparison &Comparison);
+  bool Compare(void);
+  bool FingerprintRecordings(const std::vector<int> &Ids);
+  bool PublishDuplicates(const std::vector<int> &Order);
   void Scan(void);
   bool RecordingsStateChanged(void);
+  bool Interrupted(void);
+  void Aborted(void);
+  bool WaitForTrigger(void);
 protected:
   virtual void Action(void);
 public:
   cDuplicateRecordingScannerThread();
   ~cDuplicateRecordingScannerThread();
   void Stop(void);
+  void Trigger(void);
+      ///< Requests a new scan. Further requests within the scan delay of the
+      ///< first one are combined with it.
+  void Exclude(const std::vector<std::string> &FileNames, bool Excluded = true);
+      ///< Leaves FileNames out of the following scans, or takes them up again
+      ///< if Excluded is false, e.g. while they are being deleted.
+  cDuplicateScanStatistics Statistics(void);
+      ///< Returns the statistics of the scans since the plugin was started.
 };
 
 extern cDuplicateRecordingScannerThread DuplicateRecordingScanner;
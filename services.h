@@ -0,0 +1,55 @@
+/*
+ * services.h: Services of the duplicates plugin for other plugins.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_SERVICES_H
+#define _DUPLICATES_SERVICES_H
+
+#include <memory>
+
+// --- cDuplicatesView -----------------------------------------------------------
+
+// A read-only view of the duplicate recordings list. A view is never changed
+// once it has been handed out, a changed list is handed out as a new view.
+// Its strings stay valid as long as a std::shared_ptr to it is kept. Groups
+// and recordings are numbered from 0, in the order of the plugin's menu.
+
+class cDuplicatesView {
+public:
+  virtual ~cDuplicatesView() {}
+  virtual int Generation(void) const = 0;
+      ///< Returns a number that is increased with every new list.
+  virtual int Groups(void) const = 0;
+  virtual const char *GroupText(int Group) const = 0;
+  virtual bool IsDuplicates(int Group) const = 0;
+      ///< Returns false for the group of recordings without description.
+  virtual int Recordings(void) const = 0;
+  virtual const char *FileName(int Recording) const = 0;
+  virtual int Group(int Recording) const = 0;
+  virtual int Find(const char *FileName) const = 0;
+      ///< Returns the recording with the given FileName, or -1 if it isn't in
+      ///< the list.
+  };
+
+// --- Services ------------------------------------------------------------------
+
+// "Duplicates-View-v1.0" hands out the current list.
+
+struct Duplicates_View_v1_0 {
+  std::shared_ptr<const cDuplicatesView> view; // out
+  };
+
+// "Duplicates-Lookup-v1.0" tells whether a single recording is a duplicate.
+
+struct Duplicates_Lookup_v1_0 {
+  const char *fileName; // in
+  int generation;       // out
+  int group;            // out, -1 if the recording isn't a duplicate
+  int duplicates;       // out, number of recordings in the group
+  };
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * table.c: Recording table for the duplicate recording scanner.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#include "table.h"
+#include "contains.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define MINGARBAGE 0x10000
+
+// --- cRecordingTable -----------------------------------------------------------
+
+cRecordingTable::cRecordingTable(void) {
+  garbage = 0;
+}
+
+uint32_t cRecordingTable::Hash(const char *FileName) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)FileName; *p; p++)
+    hash = (hash ^ *p) * 16777619u;
+  return hash;
+}
+
+cArenaString cRecordingTable::Store(const char *s, size_t Size) {
+  cArenaString a;
+  a.offset = arena.size();
+  a.size = Size;
+  arena.append(s, Size);
+  arena += '\0';
+  return a;
+}
+
+void cRecordingTable::Compact(void) {
+  if (garbage < MINGARBAGE || garbage < arena.size() / 2)
+    return;
+  std::string compacted;
+  compacted.reserve(arena.size() - garbage);
+  std::vector<cArenaString> *strings[] = { &fileNames, &texts, &titles, &descriptions };
+  for (int id = 0; id < Size(); id++) {
+    if (Used(id)) {
+      for (int i = 0; i < 4; i++) {
+        cArenaString &a = (*strings[i])[id];
+        uint32_t offset = compacted.size();
+        compacted.append(arena, a.offset, a.size + 1);
+        a.offset = offset;
+      }
+    }
+  }
+  arena.swap(compacted);
+  garbage = 0;
+}
+
+void cRecordingTable::Clear(void) {
+  arena.clear();
+  garbage = 0;
+  fileNames.clear();
+  texts.clear();
+  titles.clear();
+  descriptions.clear();
+  keys.clear();
+  fingerprints.clear();
+  sources.clear();
+  lengths.clear();
+  sizes.clear();
+  flags.clear();
+  freeIds.clear();
+  fileNameIds.clear();
+}
+
+int cRecordingTable::Find(const char *FileName) const {
+  std::pair<std::unordered_multimap<uint32_t, int>::const_iterator, std::unordered_multimap<uint32_t, int>::const_iterator> range = fileNameIds.equal_range(Hash(FileName));
+  for (std::unordered_multimap<uint32_t, int>::const_iterator i = range.first; i != range.second; ++i) {
+    if (strcmp(this->FileName(i->second), FileName) == 0)
+      return i->second;
+  }
+  return -1;
+}
+
+int cRecordingTable::Add(const char *FileName, const char *Text, const std::string &Title, const std::string &Description, const cInfoKey &Key) {
+  Compact();
+  int id;
+  if (freeIds.empty()) {
+    id = flags.size();
+    fileNames.push_back(cArenaString());
+    texts.push_back(cArenaString());
+    titles.push_back(cArenaString());
+    descriptions.push_back(cArenaString());
+    keys.push_back(Key);
+    fingerprints.push_back(0);
+    sources.push_back(0);
+    lengths.push_back(0);
+    sizes.push_back(0);
+    flags.push_back(0);
+  } else {
+    id = freeIds.back();
+    freeIds.pop_back();
+    keys[id] = Key;
+    fingerprints[id] = 0;
+    sources[id] = 0;
+    lengths[id] = 0;
+    sizes[id] = 0;
+  }
+  fileNames[id] = Store(FileName, strlen(FileName));
+  texts[id] = Store(Text, strlen(Text));
+  titles[id] = Store(Title.data(), Title.size());
+  descriptions[id] = Store(Description.data(), Description.size());
+  flags[id] = rfUsed | (Description.empty() ? 0 : rfHasDescription);
+  fileNameIds.insert(std::make_pair(Hash(FileName), id));
+  return id;
+}
+
+void cRecordingTable::Del(int Id) {
+  std::pair<std::unordered_multimap<uint32_t, int>::iterator, std::unordered_multimap<uint32_t, int>::iterator> range = fileNameIds.equal_range(Hash(FileName(Id)));
+  for (std::unordered_multimap<uint32_t, int>::iterator i = range.first; i != range.second; ++i) {
+    if (i->second == Id) {
+      fileNameIds.erase(i);
+      break;
+    }
+  }
+  Release(fileNames[Id]);
+  Release(texts[Id]);
+  Release(titles[Id]);
+  Release(descriptions[Id]);
+  flags[Id] = 0;
+  freeIds.push_back(Id);
+}
+
+void cRecordingTable::ClearFlags(int Flags) {
+  for (std::vector<unsigned char>::iterator f = flags.begin(); f != flags.end(); ++f)
+    *f &= ~Flags;
+}
+
+void cRecordingTable::SetText(int Id, const char *Text) {
+  if (strcmp(this->Text(Id), Text) != 0) {
+    Compact();
+    Release(texts[Id]);
+    texts[Id] = Store(Text, strlen(Text));
+  }
+}
+
+bool cRecordingTable::SameContent(int Id, const std::string &Title, const std::string &Description) const {
+  return TitleSize(Id) == Title.size() && memcmp(this->Title(Id), Title.data(), Title.size()) == 0
+         && DescriptionSize(Id) == Description.size() && memcmp(this->Description(Id), Description.data(), Description.size()) == 0;
+}
+
+bool cRecordingTable::TitlesMatch(int Id1, int Id2) const {
+  return TitleSize(Id1) > TitleSize(Id2) ?
+           Contains(Title(Id1), TitleSize(Id1), Title(Id2), TitleSize(Id2)) : Contains(Title(Id2), TitleSize(Id2), Title(Id1), TitleSize(Id1));
+}
+
+bool cRecordingTable::Matches(int Id1, int Id2, bool CompareTitle) const {
+  if (!HasDescription(Id1) || !HasDescription(Id2))
+    return false;
+
+  if (CompareTitle && !TitlesMatch(Id1, Id2))
+    return false;
+
+  return DescriptionSize(Id1) > DescriptionSize(Id2) ?
+           Contains(Description(Id1), DescriptionSize(Id1), Description(Id2), DescriptionSize(Id2)) : Contains(Description(Id2), DescriptionSize(Id2), Description(Id1), DescriptionSize(Id1));
+}
+
+bool cRecordingTable::SimilarMeasures(int Id1, int Id2, int LengthTolerance, int SizeTolerance) const {
+  if (LengthTolerance && lengths[Id1] && lengths[Id2] && abs(lengths[Id1] - lengths[Id2]) > LengthTolerance * 60)
+    return false;
+  if (SizeTolerance && sizes[Id1] && sizes[Id2])
+    return abs(sizes[Id1] - sizes[Id2]) * 100 <= SizeTolerance * std::max(sizes[Id1], sizes[Id2]);
+  return true;
+}
+
+size_t cRecordingTable::MemoryUsage(void) const {
+  return arena.capacity() + flags.capacity() * (4 * sizeof(cArenaString) + sizeof(cInfoKey) + 2 * sizeof(uint64_t) + 2 * sizeof(int) + 1) + fileNameIds.size() * (sizeof(uint32_t) + sizeof(int) + 2 * sizeof(void *));
+}
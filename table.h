@@ -0,0 +1,103 @@
+/*
+ * table.h: Recording table for the duplicate recording scanner.
+ *
+ * See the README file for copyright information and how to reach the author.
+ *
+ * $Id$
+ */
+
+#ifndef _DUPLICATES_TABLE_H
+#define _DUPLICATES_TABLE_H
+
+#include "cache.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// --- eRecordingFlags -----------------------------------------------------------
+
+enum eRecordingFlags {
+  rfUsed           = 0x01,
+  rfHasDescription = 0x02,
+  rfChecked        = 0x04,
+  rfHidden         = 0x08,
+  rfVisibility     = 0x10, // rfHidden is valid
+  rfFingerprint    = 0x40, // the content fingerprint is valid
+  rfMeasured       = 0x80, // the length and size are valid
+  };
+
+// --- cArenaString --------------------------------------------------------------
+
+struct cArenaString {
+  uint32_t offset;
+  uint32_t size;
+};
+
+// --- cRecordingTable -----------------------------------------------------------
+
+// The recordings known to the scanner, stored as a struct of arrays. All
+// strings are kept in one arena and referenced by offset and size. Pointers
+// to strings are only valid until the next call to Add() or SetText().
+
+class cRecordingTable {
+private:
+  std::string arena;
+  size_t garbage;
+  std::vector<cArenaString> fileNames;
+  std::vector<cArenaString> texts;
+  std::vector<cArenaString> titles;
+  std::vector<cArenaString> descriptions;
+  std::vector<cInfoKey> keys;
+  std::vector<uint64_t> fingerprints;
+  std::vector<uint64_t> sources; // hashes of the info texts, 0 if unknown
+  std::vector<int> lengths; // s
+  std::vector<int> sizes; // MB
+  std::vector<unsigned char> flags;
+  std::vector<int> freeIds;
+  std::unordered_multimap<uint32_t, int> fileNameIds;
+  static uint32_t Hash(const char *FileName);
+  cArenaString Store(const char *s, size_t Size);
+  void Release(const cArenaString &s) { garbage += s.size + 1; }
+  void Compact(void);
+public:
+  cRecordingTable(void);
+  void Clear(void);
+  int Size(void) const { return flags.size(); }
+  int Count(void) const { return flags.size() - freeIds.size(); }
+  int Find(const char *FileName) const;
+  int Add(const char *FileName, const char *Text, const std::string &Title, const std::string &Description, const cInfoKey &Key);
+  void Del(int Id);
+  bool Used(int Id) const { return flags[Id] & rfUsed; }
+  bool HasDescription(int Id) const { return flags[Id] & rfHasDescription; }
+  bool Flag(int Id, int Flag) const { return flags[Id] & Flag; }
+  void SetFlag(int Id, int Flag, bool On = true) { if (On) flags[Id] |= Flag; else flags[Id] &= ~Flag; }
+  void ClearFlags(int Flags);
+  const char *FileName(int Id) const { return arena.data() + fileNames[Id].offset; }
+  const char *Text(int Id) const { return arena.data() + texts[Id].offset; }
+  void SetText(int Id, const char *Text);
+  const char *Title(int Id) const { return arena.data() + titles[Id].offset; }
+  size_t TitleSize(int Id) const { return titles[Id].size; }
+  const char *Description(int Id) const { return arena.data() + descriptions[Id].offset; }
+  size_t DescriptionSize(int Id) const { return descriptions[Id].size; }
+  const cInfoKey &Key(int Id) const { return keys[Id]; }
+  void SetKey(int Id, const cInfoKey &Key) { keys[Id] = Key; }
+  uint64_t Fingerprint(int Id) const { return fingerprints[Id]; }
+  void SetFingerprint(int Id, uint64_t Fingerprint) { fingerprints[Id] = Fingerprint; flags[Id] |= rfFingerprint; }
+  uint64_t Source(int Id) const { return sources[Id]; }
+  void SetSource(int Id, uint64_t Source) { sources[Id] = Source; }
+  int Length(int Id) const { return lengths[Id]; }
+  int FileSize(int Id) const { return sizes[Id]; }
+  void SetMeasures(int Id, int Length, int Size) { lengths[Id] = Length; sizes[Id] = Size; flags[Id] |= rfMeasured; }
+  bool SameContent(int Id, const std::string &Title, const std::string &Description) const;
+  bool TitlesMatch(int Id1, int Id2) const;
+  bool Matches(int Id1, int Id2, bool CompareTitle) const;
+  bool SimilarMeasures(int Id1, int Id2, int LengthTolerance, int SizeTolerance) const;
+      ///< Returns false if the lengths of the recordings differ by more than
+      ///< LengthTolerance minutes or their sizes by more than SizeTolerance
+      ///< percent of the larger one. A tolerance of 0 and an unknown length or
+      ///< size never reject a pair.
+  size_t MemoryUsage(void) const;
+};
+
+#endif
@@ -6,17 +6,24 @@
  * $Id$
  */
 
+#include "config.h"
 #include "visibility.h"
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+#define HIDDENFILENAME  "duplicates.hidden"
+#define RESOLVEINTERVAL 600 // seconds until a marker file is read again
 
 // --- cVisibility -----------------------------------------------------------
 
-cVisibility::cVisibility(const char *fileName) {
-  hiddenFileName = AddDirectory(fileName, "duplicates.hidden");
+cVisibility::cVisibility(const char *fileName) : fileName(fileName) {
   visibility = UNKNOWN;
 }
 
 cVisibility::cVisibility(const cVisibility &Visibility) :
-  hiddenFileName(Visibility.hiddenFileName),
+  fileName(Visibility.fileName),
   visibility(Visibility.visibility) {}
 
 eVisibility cVisibility::Get(void) {
@@ -28,26 +35,338 @@ void cVisibility::Set(bool visible) {
 }
 
 eVisibility cVisibility::Read(void) {
-  if (visibility == UNKNOWN) {
-    visibility = access(hiddenFileName, F_OK) == 0 ? HIDDEN : VISIBLE;
-  }
+  if (*fileName)
+    visibility = VisibilityCache.Hidden(fileName) ? HIDDEN : VISIBLE;
   return visibility;
 }
 
 bool cVisibility::Write(bool visible) {
-  if (visible) {
-    if (remove(hiddenFileName) == 0) {
-      visibility = VISIBLE;
-      return true;
+  if (VisibilityCache.Write(fileName, !visible)) {
+    visibility = visible ? VISIBLE : HIDDEN;
+    return true;
+  }
+  return false;
+}
+
+// --- cVisibilityCache ------------------------------------------------------
+
+static bool HasMarker(const char *FileName) {
+  return access(AddDirectory(FileName, HIDDENFILENAME), F_OK) == 0;
+}
+
+static bool CreateMarker(const char *FileName) {
+  cString hiddenFileName = AddDirectory(FileName, HIDDENFILENAME);
+  if (access(hiddenFileName, F_OK) == 0)
+    return true;
+  if (FILE *f = fopen(hiddenFileName, "w")) {
+    fclose(f);
+    return true;
+  }
+  LOG_ERROR_STR(*hiddenFileName);
+  return false;
+}
+
+cVisibilityCache::cVisibilityCache(void) {
+  fd = -1;
+  updates = 0;
+  changed = false;
+  journaled = false;
+  switching = false;
+  watchLimit = false;
+}
+
+cVisibilityCache::~cVisibilityCache() {
+  if (fd >= 0)
+    close(fd);
+}
+
+bool cVisibilityCache::Resolve(const std::string &FileName, int &Watch) {
+#ifdef __linux__
+  if (Watch < 0 && fd >= 0) {
+    // the watch is added first, so that no change can get lost in between
+    Watch = inotify_add_watch(fd, FileName.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+    if (Watch < 0 && errno == ENOSPC && !watchLimit) {
+      watchLimit = true;
+      esyslog("duplicates: Out of inotify watches, raise /proc/sys/fs/inotify/max_user_watches to watch all recordings.");
+    }
+  }
+#endif
+  return HasMarker(FileName.c_str());
+}
+
+void cVisibilityCache::Unwatch(tEntry &Entry) {
+#ifdef __linux__
+  if (Entry.watch >= 0) {
+    inotify_rm_watch(fd, Entry.watch);
+    watches.erase(Entry.watch);
+    Entry.watch = -1;
+  }
+#endif
+}
+
+void cVisibilityCache::Forget(void) {
+  for (std::unordered_map<std::string, tEntry>::iterator e = entries.begin(); e != entries.end(); ++e)
+    Unwatch(e->second);
+  entries.clear();
+}
+
+void cVisibilityCache::Process(void) {
+#ifdef __linux__
+  if (fd < 0)
+    return;
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+    for (char *p = buffer; p < buffer + n; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len) {
+      const struct inotify_event *event = (struct inotify_event *)p;
+      if (event->mask & IN_Q_OVERFLOW) {
+        // events have been lost, so everything is read again with the next update
+        for (std::unordered_map<std::string, tEntry>::iterator e = entries.begin(); e != entries.end(); ++e)
+          e->second.resolved = 0;
+        changed = true;
+        continue;
+      }
+      std::map<int, std::string>::iterator w = watches.find(event->wd);
+      if (w == watches.end()) {
+        // the watch is still being added by Update()
+        strays.insert(event->wd);
+        continue;
+      }
+      std::unordered_map<std::string, tEntry>::iterator e = entries.find(w->second);
+      if (event->mask & IN_IGNORED) {
+        // the recording directory is gone
+        if (e != entries.end())
+          e->second.watch = -1;
+        watches.erase(w);
+      } else if (e != entries.end() && event->len && strcmp(event->name, HIDDENFILENAME) == 0) {
+        bool hidden = (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+        e->second.modified = updates;
+        if (e->second.hidden != hidden) {
+          e->second.hidden = hidden;
+          changed = true;
+        }
+      }
     }
-  } else {
+  }
+#endif
+}
+
+void cVisibilityCache::SetJournaled(bool On, const std::vector<const char *> &FileNames) {
+  // The marker files are read and written without the lock. Hidden states
+  // that are changed meanwhile are collected by Write() and applied on top.
+  if (!On) {
+    std::unordered_set<std::string> hidden;
+    {
+      cMutexLock MutexLock(&mutex);
+      if (!journal.IsOpen() && !journal.Open(false))
+        return;
+      hidden = journal.HiddenRecordings();
+      switching = true;
+    }
+    // The hidden state goes back into marker files. Only the recordings that
+    // are missing right now, e.g. on a disk that isn't mounted, stay in the
+    // journal.
+    std::set<std::string> missing;
+    int exported = 0;
+    for (std::unordered_set<std::string>::const_iterator h = hidden.begin(); h != hidden.end(); ++h) {
+      if (access(h->c_str(), F_OK) != 0)
+        missing.insert(*h);
+      else if (HasMarker(h->c_str()))
+        continue;
+      else if (CreateMarker(h->c_str()))
+        exported++;
+      else
+        missing.insert(*h);
+    }
+    cMutexLock MutexLock(&mutex);
+    for (std::map<std::string, bool>::const_iterator w = written.begin(); w != written.end(); ++w) {
+      if (!w->second) {
+        remove(AddDirectory(w->first.c_str(), HIDDENFILENAME));
+        missing.erase(w->first);
+      } else if (!CreateMarker(w->first.c_str()))
+        missing.insert(w->first);
+    }
+    std::vector<const char *> rest;
+    for (std::set<std::string>::const_iterator m = missing.begin(); m != missing.end(); ++m)
+      rest.push_back(m->c_str());
+    journal.Rewrite(rest);
+    journal.Close();
+    isyslog("duplicates: Exported %d hidden recordings from the journal.", exported);
+    Forget();
+    journaled = false;
+    switching = false;
+    written.clear();
+    return;
+  }
+  {
+    cMutexLock MutexLock(&mutex);
+    switching = true;
+  }
+  // Marker files may have been created before the journal or while it was
+  // switched off. In journal mode a recording that is unhidden loses its
+  // marker file, so all of them can be taken over.
+  std::set<std::string> marked;
+  for (std::vector<const char *>::const_iterator f = FileNames.begin(); f != FileNames.end(); ++f) {
+    if (HasMarker(*f))
+      marked.insert(*f);
+  }
+  cMutexLock MutexLock(&mutex);
+  for (std::map<std::string, bool>::const_iterator w = written.begin(); w != written.end(); ++w) {
+    if (w->second)
+      marked.insert(w->first);
+    else
+      marked.erase(w->first);
+  }
+  Forget();
+  journaled = true;
+  switching = false;
+  written.clear();
+  bool exists = journal.Open();
+  std::vector<const char *> hidden;
+  int imported = 0;
+  for (std::set<std::string>::const_iterator m = marked.begin(); m != marked.end(); ++m) {
+    hidden.push_back(m->c_str());
+    if (!journal.Hidden(*m))
+      imported++;
+  }
+  if (exists && !imported)
+    return;
+  const std::unordered_set<std::string> &stored = journal.HiddenRecordings();
+  for (std::unordered_set<std::string>::const_iterator h = stored.begin(); h != stored.end(); ++h)
+    hidden.push_back(h->c_str());
+  if (journal.Rewrite(hidden))
+    isyslog("duplicates: Imported %d hidden recordings into the journal.", imported);
+}
+
+void cVisibilityCache::Update(const std::vector<const char *> &FileNames) {
+  if (journaled != (dc.journal != 0))
+    SetJournaled(dc.journal, FileNames);
+  else if (!updates && !journaled)
+    SetJournaled(false, FileNames); // switched off before the hidden state was written back
+  std::vector<tResolution> pending;
+  int update;
+  {
+    cMutexLock MutexLock(&mutex);
+#ifdef __linux__
+    if (fd < 0 && !journaled) {
+      fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (fd < 0)
+        LOG_ERROR_STR("inotify_init1");
+    }
+#endif
+    Process();
+    update = ++updates;
+    time_t now = time(NULL);
+    for (std::vector<const char *>::const_iterator f = FileNames.begin(); f != FileNames.end(); ++f) {
+      std::unordered_map<std::string, tEntry>::iterator e = entries.find(*f);
+      if (e == entries.end()) {
+        if (journaled) {
+          tEntry &entry = entries[*f];
+          entry.hidden = journal.Hidden(*f);
+          entry.watch = -1;
+          entry.update = update;
+          entry.modified = 0;
+          entry.resolved = now;
+        } else {
+          tResolution r = { *f, -1, false };
+          pending.push_back(r);
+        }
+        continue;
+      }
+      e->second.update = update;
+      if (!journaled && now - e->second.resolved >= RESOLVEINTERVAL) {
+        tResolution r = { *f, e->second.watch, false };
+        pending.push_back(r);
+      }
+    }
+    for (std::unordered_map<std::string, tEntry>::iterator e = entries.begin(); e != entries.end();) {
+      if (e->second.update != update) {
+        Unwatch(e->second);
+        e = entries.erase(e);
+      } else
+        ++e;
+    }
+  }
+  for (std::vector<tResolution>::iterator r = pending.begin(); r != pending.end(); ++r)
+    r->hidden = Resolve(r->fileName, r->watch);
+  cMutexLock MutexLock(&mutex);
+  Process();
+  time_t now = time(NULL);
+  for (std::vector<tResolution>::const_iterator r = pending.begin(); r != pending.end(); ++r) {
+    std::pair<std::unordered_map<std::string, tEntry>::iterator, bool> e = entries.insert(std::make_pair(r->fileName, tEntry()));
+    tEntry &entry = e.first->second;
+    if (e.second) {
+      entry.watch = -1;
+      entry.update = update;
+      entry.modified = 0;
+    }
+    if (r->watch >= 0) {
+      entry.watch = r->watch;
+      watches[r->watch] = r->fileName;
+    }
+    if (r->watch >= 0 && strays.count(r->watch))
+      entry.hidden = HasMarker(r->fileName.c_str()); // changed before the watch was known
+    else if (e.second || entry.modified != update)
+      entry.hidden = r->hidden;
+    entry.resolved = now;
+  }
+  strays.clear();
+  changed = false;
+  if (journaled && journal.NeedsCompaction())
+    journal.Compact();
+  dsyslog("duplicates: Resolved visibility of %d of %d recordings, %d watched.", (int)pending.size(), (int)entries.size(), (int)watches.size());
+}
+
+bool cVisibilityCache::Hidden(const char *FileName) {
+  {
+    cMutexLock MutexLock(&mutex);
+    std::unordered_map<std::string, tEntry>::const_iterator e = entries.find(FileName);
+    if (e != entries.end())
+      return e->second.hidden;
+    if (journaled)
+      return journal.Hidden(FileName);
+  }
+  // not scanned yet, the next update takes it over
+  return HasMarker(FileName);
+}
+
+bool cVisibilityCache::Write(const char *FileName, bool Hidden) {
+  cMutexLock MutexLock(&mutex);
+  cString hiddenFileName = AddDirectory(FileName, HIDDENFILENAME);
+  if (journaled) {
+    if (!journal.Set(FileName, Hidden))
+      return false;
+    if (!Hidden)
+      remove(hiddenFileName); // a marker file from before the import would hide it again without the journal
+  } else if (Hidden) {
     FILE *f = fopen(hiddenFileName, "w");
-    if (f) {
-      fclose(f);
-      visibility = HIDDEN;
-      return true;
+    if (!f)
+      return false;
+    fclose(f);
+  } else if (remove(hiddenFileName) != 0)
+    return false;
+  if (switching)
+    written[FileName] = Hidden;
+  std::unordered_map<std::string, tEntry>::iterator e = entries.find(FileName);
+  if (e != entries.end()) {
+    e->second.hidden = Hidden;
+    e->second.modified = updates;
+  }
+  return true;
+}
+
+bool cVisibilityCache::Changed(void) {
+#ifdef __linux__
+  // polled by the main loop, which only waits for the lock when there are events
+  if (fd >= 0) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 0) > 0) {
+      cMutexLock MutexLock(&mutex);
+      Process();
     }
   }
-  return false;
+#endif
+  return changed.exchange(false);
 }
 
+cVisibilityCache VisibilityCache;
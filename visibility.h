@@ -9,7 +9,15 @@
 #ifndef _DUPLICATES_VISIBILITY_H
 #define _DUPLICATES_VISIBILITY_H
 
+#include "journal.h"
 #include <vdr/recording.h>
+#include <vdr/thread.h>
+#include <atomic>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // --- eVisibility -----------------------------------------------------------
 
@@ -19,7 +27,7 @@ enum eVisibility {UNKNOWN, VISIBLE, HIDDEN};
 
 class cVisibility {
 private:
-  cString hiddenFileName;
+  cString fileName;
   eVisibility visibility;
 public:
   cVisibility(const char *fileName);
@@ -30,4 +38,62 @@ public:
   bool Write(bool visible);
 };
 
+// --- cVisibilityCache ------------------------------------------------------
+
+// Keeps the hidden state of all recordings in memory. The recording
+// directories are watched with inotify where available, so that the state
+// only has to be read once per recording. Recordings that can't be watched
+// are read again every ten minutes, and so are the watched ones, since
+// inotify doesn't see changes made by other clients of a network mount.
+// Optionally the state is kept in a cHiddenJournal instead of marker files
+// in the recording directories. The file system is only accessed without
+// holding the lock, which the main thread and the OSD take as well.
+
+class cVisibilityCache {
+private:
+  struct tEntry {
+    bool hidden;
+    int watch;
+    int update;
+    int modified;
+    time_t resolved;
+  };
+  struct tResolution {
+    std::string fileName;
+    int watch;
+    bool hidden;
+  };
+  cMutex mutex;
+  std::atomic<int> fd;
+  int updates;
+  std::atomic<bool> changed;
+  bool journaled;
+  bool switching;
+  bool watchLimit;
+  cHiddenJournal journal;
+  std::unordered_map<std::string, tEntry> entries;
+  std::map<int, std::string> watches;
+  std::set<int> strays;
+  std::map<std::string, bool> written;
+  bool Resolve(const std::string &FileName, int &Watch);
+  void Unwatch(tEntry &Entry);
+  void Forget(void);
+  void Process(void);
+  void SetJournaled(bool On, const std::vector<const char *> &FileNames);
+public:
+  cVisibilityCache(void);
+  ~cVisibilityCache();
+  void Update(const std::vector<const char *> &FileNames);
+      ///< Resolves the hidden state of all the given recordings in one pass
+      ///< and forgets about all others. Only called by the scanner.
+  bool Hidden(const char *FileName);
+  bool Write(const char *FileName, bool Hidden);
+  bool Changed(void);
+      ///< Returns true if the hidden state of a recording has been changed
+      ///< outside of this plugin since the last call. Only takes the lock
+      ///< when there are changes to be processed.
+};
+
+extern cVisibilityCache VisibilityCache;
+
 #endif